@@ -127,6 +127,7 @@ public:
 
 	void SetElement (IT indx, NT numx);	// element-wise assignment
 	void SetLocalElement(IT index, NT value) {  arr[index] = value; }; // no checks, local index
+	NT   GetLocalElement(IT index) const { return arr[index]; }; // no checks, local index
 	NT   GetElement (IT indx) const;	// element-wise fetch
 	NT operator[](IT indx) const		// more c++ like API
 	{
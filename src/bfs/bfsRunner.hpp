@@ -28,10 +28,16 @@
 
 #include <mpi.h>
 #include <iostream>
+#include <fstream>
+#include <memory>
+#include <numeric>
 #include <unordered_set>
 
 //Own includes
 #include "graphGen/common/reduceIds.hpp"
+#include "graphGen/common/idDictionary.hpp"
+#include "graphGen/common/idMapping.hpp"
+#include "graphGen/common/sortedAdjacency.hpp"
 #include "bfs/timer.hpp"
 #include "utils/commonfuncs.hpp"
 
@@ -47,6 +53,46 @@ namespace conn
 {
   namespace bfs
   {
+    /**
+     * @brief     Parameters that decide when the adaptive BFS phase hands off to coloring
+     * @details   BFS is relaunched as long as the component discovered last is big compared 
+     *            to the edges that are still untraversed. Once components get small, coloring
+     *            is the cheaper way to finish the remaining graph
+     */
+    struct bfsContinuationPolicy
+    {
+      //Keep running BFS while the last component holds more than this fraction of the remaining edges
+      double minComponentMassFraction = 0.1;
+
+      //Stop if MTEPS of the last BFS drops below this fraction of the best MTEPS seen so far (0 disables the check)
+      double minMTEPSFraction = 0.0;
+
+      //Upper bound on the count of BFS runs
+      std::size_t maxIterations = std::numeric_limits<std::size_t>::max();
+    };
+
+    /**
+     * @brief     Statistics recorded for a single level of a BFS run
+     * @details   Times are in milliseconds, maximum across the ranks. Communication volume 
+     *            is not measured, CombBLAS does not report it. It is modeled from the frontier
+     *            sizes after the 2D SpMV: the input frontier is gathered along processor 
+     *            columns and the output frontier is merged along processor rows, each 
+     *            entry being an (index, value) pair. The output entries of already visited
+     *            vertices are not counted, so the model is a lower bound.
+     */
+    struct bfsLevelStats
+    {
+      std::size_t bfsRun;             //BFS iteration this level belongs to, starting from 0
+      std::size_t level;              //Level in the BFS tree, source is at level 0
+      std::size_t frontierSize;       //nnz of the frontier expanded at this level
+      std::size_t edgesExamined;      //Sum of degrees of the frontier vertices
+      std::size_t discoveredSize;     //Count of new vertices found at this level
+      double timeSpMV;
+      double timeEWiseMult;
+      double timeRemoveFromHash;
+      std::size_t modeledBytes;       //Estimate, see the model above
+    };
+
     /**
      * @class                     conn::bfs::bfsSupport
      * @brief                     supports parallel connected component labeling using BFS iterations
@@ -82,6 +128,12 @@ namespace conn
           //Record MTEPS score of each iteration
           std::vector<double> MTEPS;
 
+          //Record count of edges traversed during each iteration (edges are counted both ways)
+          std::vector<std::size_t> componentEdgeCounts;
+
+          //Total count of edges in the adjacency matrix (sum of vertex degrees)
+          std::size_t totalEdgeCount;
+
           //This is the communicator which participates for computing the components
           mxx::comm comm;
 
@@ -98,6 +150,34 @@ namespace conn
           //Size of the parents array local to this rank
           std::size_t localDistVecSize;
 
+          //Count of vertices in the adjacency matrix
+          std::size_t nVertices;
+
+          //Sort order of the edge list, if known to the caller
+          conn::graphGen::sortedAdjacency<E> *adjacency = nullptr;
+
+          //Maps the vertex ids to contiguous ids, used only if the input ids are not contiguous
+          std::unique_ptr< conn::graphGen::idDictionary<E> > dictionary;
+
+          //Local ids of vertices on this rank, ordered by decreasing degree
+          //Used to pick the BFS sources
+          std::vector<E> sourceCandidates;
+
+          //Candidates before this position are already visited
+          std::size_t sourceCandidatesPos = 0;
+
+          //Switch to record per level statistics, costs an extra reduction per level
+          bool levelStatsEnabled = false;
+
+          //Per level statistics of all the BFS runs
+          std::vector<bfsLevelStats> levelStats;
+
+          //Switch to record the component label of the visited vertices
+          bool vertexLabelsEnabled = false;
+
+          //<contiguous id, BFS source> of the vertices visited by all the BFS runs
+          std::vector< std::pair<E, E> > visitedLabels;
+
         public:
 
         /**
@@ -111,53 +191,56 @@ namespace conn
         bfsSupport(std::vector< std::pair<E, E> > &_edgeList, std::size_t vertexCount,
                   const mxx::comm &_comm) : edgeList(_edgeList), comm(_comm.copy()), A(comm), degrees(comm)
         {
-          //List of edges, distributed in 1D fashion
-          DistEdgeList<E> *DEL = new DistEdgeList<E>();
-
-          //Copy our edgeList to CombBLAS format of edgeList
-          DEL->GenGraphData(edgeList, vertexCount);
-
-          comm.barrier();
-
-          integerMatrixType *G = new integerMatrixType(*DEL, false); 
-          delete DEL;	// free memory
-
-          comm.barrier();
-
-          //Compute the vertex degrees
-          G->Reduce(degrees, Row, plus<E>(), static_cast<E>(0));	// Identity is 0 
-
-          comm.barrier();
-
-          //Now represent the adj matrix in the boolean format
-          A =  booleanMatrixType(*G);			// Convert to Boolean
-          delete G;
+          buildAdjacencyMatrix(edgeList, vertexCount);
+        }
 
-          //Copied the statement from TopDownBFS code
-          //Some kind of optimization for graph500 graphs is expected here
-          A.OptimizeForGraph500(optbuf);		          
+        /**
+         * @brief                 constructor for graphs with arbitrary (e.g. hashed) vertex ids, 
+         *                        builds the adjacency matrix required for BFS
+         * @param[in] edgeList    input graph as distributed edgeList, vertex ids need not be contiguous
+         * @param[in] comm        mpi communicator
+         * @details               Contiguous ids for the adjacency matrix are obtained from a distributed
+         *                        dictionary (hash routed all2all of the unique vertex ids), so the
+         *                        edge list doesn't need to be relabeled with reduceVertexIds() first.
+         *                        edgeList keeps its original ids.
+         */
+        bfsSupport(std::vector< std::pair<E, E> > &_edgeList, const mxx::comm &_comm) 
+          : edgeList(_edgeList), comm(_comm.copy()), A(comm), degrees(comm)
+        {
+          dictionary = std::unique_ptr< conn::graphGen::idDictionary<E> >(new conn::graphGen::idDictionary<E>(edgeList, comm));
 
-          comm.barrier();
+          LOG_IF(comm.rank() == 0, INFO) << "Vertex id dictionary built, count of vertices -> " << dictionary->size();
 
-          //Helper to initialize the unvisited vertices buffer
-          FullyDistVec<E,E> tmp(A.getcommgrid(), A.getncol(), (E)-1);
+          //Temporary copy of the edges with contiguous ids
+          std::vector< std::pair<E, E> > contiguousEdgeList(edgeList);
+          dictionary->relabel(contiguousEdgeList);
 
-          //Record the local array size
-          localDistVecSize = tmp.LocArrSize();
+          buildAdjacencyMatrix(contiguousEdgeList, dictionary->size());
+        }
 
-          for(E i = 0; i < tmp.LocArrSize(); i++)
-          {
-            //Note that we are saving local id of every vertex
-            //This gets convenient when we erase the visited elements later
-            unVisitedVertices.emplace(i);
-          }
+        /**
+         * @brief                 constructors over an edge list with known sort order, 
+         *                        filterEdgeList() reuses the order instead of checking it
+         * @param[in] adjacency   input graph, should outlive this object
+         */
+        bfsSupport(conn::graphGen::sortedAdjacency<E> &_adjacency, std::size_t vertexCount,
+                  const mxx::comm &_comm) : bfsSupport(_adjacency.edges(), vertexCount, _comm)
+        {
+          adjacency = &_adjacency;
+        }
 
-          comm.barrier();
+        bfsSupport(conn::graphGen::sortedAdjacency<E> &_adjacency, const mxx::comm &_comm) 
+          : bfsSupport(_adjacency.edges(), _comm)
+        {
+          adjacency = &_adjacency;
+        }
 
-          //Print the size of map
-          auto localSize = unVisitedVertices.size();
-          auto totalSize = mxx::reduce(localSize, 0, std::plus<size_t>(), comm); 
-          LOG_IF(comm.rank() == 0, INFO) << "BFS_DEBUG size of map -> " << totalSize;
+        /**
+         * @brief     count of vertices in the adjacency matrix
+         */
+        std::size_t getVertexCount() const
+        {
+          return nVertices;
         }
 
         /**
@@ -208,47 +291,90 @@ namespace conn
             //Set to 1 as we include the source
             std::size_t trackCountOfVerticesVisited = 1;
 
+            //Statistics of this BFS run
+            std::vector<bfsLevelStats> thisRunLevelStats;
+
             timePoint t1 = clock::now(); 
 
+            //Count of vertices in the frontier
+            E frontierSize = fringe.getnnz();
+
             //Till the frontier is non-empty
-            while (fringe.getnnz() > 0)
+            while (frontierSize > 0)
             {
+              bfsLevelStats stats = {};
+              stats.bfsRun = MTEPS.size();
+              stats.level = thisRunLevelStats.size();
+              stats.frontierSize = frontierSize;
+
+              if(levelStatsEnabled)
+                stats.edgesExamined = countEdgesOfFrontier(fringe);
+
               // Top-down
               fringe.setNumToInd();
 
+              timePoint l1 = clock::now();
+
               //Matrix multiplication
               fringe = SpMV(A, fringe, optbuf);
 
+              timePoint l2 = clock::now();
+
               //Remove elements from frontier that were already visited before
               fringe = EWiseMult(fringe, parents, true, (int64_t) -1);
 
+              timePoint l3 = clock::now();
+
               //Update parents array using fringe
               parents.Set(fringe);
 
+              timePoint l4 = clock::now();
+
               //Remove the newly visited elements from our map of vertices
               fringe.removeFromHash(unVisitedVertices);
-              trackCountOfVerticesVisited += fringe.getnnz();
+
+              timePoint l5 = clock::now();
+
+              stats.timeSpMV = duration(l2 - l1).count();
+              stats.timeEWiseMult = duration(l3 - l2).count();
+              stats.timeRemoveFromHash = duration(l5 - l4).count();
+
+              stats.discoveredSize = fringe.getnnz();
+              trackCountOfVerticesVisited += stats.discoveredSize;
+
+              thisRunLevelStats.push_back(stats);
+
+              //New frontier
+              frontierSize = stats.discoveredSize;
             }
 
             //Keep record of the number of vertices visited
             countComponentSizes.push_back(trackCountOfVerticesVisited);
 
+            //Source of this run labels its component
+            if(vertexLabelsEnabled)
+              for(E v = 0; v < localDistVecSize; v++)
+                if(parents.GetLocalElement(v) != -1)
+                  visitedLabels.emplace_back(v + offsetForLocalToGlobal, srcPoint);
+
             comm.barrier();
 
             FullyDistSpVec<E, E> parentsp = parents.Find(std::bind2nd(std::greater<E>(), -1));
             parentsp.Apply(myset<E>(1));
 
             //Number of edges traversed
-            //std::size_t nEdgesTraversed = EWiseMult(parentsp, degrees, false, 0).Reduce(plus<E>(), 0);
             E nEdgesTraversed = EWiseMult(parentsp, degrees, false, (E) 0).Reduce(plus<E>(), (E) 0);
 
-            LOG_IF(comm.rank() == 0, INFO) << "BFS_DEBUG nEdgeTraversed -> " << nEdgesTraversed;
+            componentEdgeCounts.push_back(nEdgesTraversed);
 
             //Record the end time of this BFS iteration
             timePoint t2 = clock::now(); 
 
             //MTEPS = Million edges traversed per second, time is computed in milli seconds
-            double MTEPS_Score = static_cast<double>(nEdgesTraversed) / duration(t2 - t1).count() /1000000000.0;
+            double MTEPS_Score = static_cast<double>(nEdgesTraversed) / (duration(t2 - t1).count() * 1000.0);
+
+            if(levelStatsEnabled)
+              saveLevelStats(thisRunLevelStats);
 
             //Pushing the MTEPS score to our MTEPS vector
             //Take the minimum, although they won't vary much due to barriers
@@ -261,6 +387,143 @@ namespace conn
 
         }
 
+        /**
+         * @brief                             runs bfs iterations till the discovered components become small
+         * @param[out]  countComponentSizes   vector of count of vertices visited during each BFS run
+         * @param[in]   policy                thresholds that decide when to stop
+         * @details                           After each BFS run, the edge count of the discovered component
+         *                                    is compared against the edges not traversed yet. BFS is relaunched
+         *                                    only if the component is larger than the configured fraction,
+         *                                    and if the MTEPS score did not degrade too much.
+         *                                    The remaining graph is expected to be handled by coloring.
+         * @return                            number of iterations executed by BFS
+         */
+        std::size_t runBFSIterationsAdaptive(std::vector<std::size_t> &countComponentSizes, 
+            const bfsContinuationPolicy &policy = bfsContinuationPolicy())
+        {
+          std::size_t iterationsExecuted = 0;
+
+          while(iterationsExecuted < policy.maxIterations)
+          {
+            //Returns 0 if all vertices were already visited
+            if(runBFSIterations(1, countComponentSizes) == 0)
+              break;
+
+            iterationsExecuted++;
+
+            std::size_t lastComponentEdges = componentEdgeCounts.back();
+            std::size_t traversedEdges = std::accumulate(componentEdgeCounts.begin(), componentEdgeCounts.end(), static_cast<std::size_t>(0));
+            std::size_t remainingEdges = traversedEdges < totalEdgeCount ? totalEdgeCount - traversedEdges : 0;
+
+            double bestMTEPS = *std::max_element(MTEPS.begin(), MTEPS.end());
+
+            LOG_IF(comm.rank() == 0, INFO) << "BFS run #" << iterationsExecuted << " traversed " << lastComponentEdges 
+              << " edges, " << remainingEdges << " edges remaining, MTEPS -> " << MTEPS.back();
+
+            //Nothing left for another BFS
+            if(remainingEdges == 0)
+              break;
+
+            //Components are getting small, coloring should take over
+            if(lastComponentEdges <= policy.minComponentMassFraction * remainingEdges)
+            {
+              LOG_IF(comm.rank() == 0, INFO) << "Last component below " << policy.minComponentMassFraction << " of the remaining edges, stopping BFS";
+              break;
+            }
+
+            //BFS is running too inefficiently on the small components
+            if(MTEPS.back() < policy.minMTEPSFraction * bestMTEPS)
+            {
+              LOG_IF(comm.rank() == 0, INFO) << "MTEPS dropped below " << policy.minMTEPSFraction << " of the best run, stopping BFS";
+              break;
+            }
+          }
+
+          return iterationsExecuted;
+        }
+
+        /**
+         * @brief       enable or disable recording of per level statistics during BFS runs
+         */
+        void enableLevelStats(bool enable = true)
+        {
+          levelStatsEnabled = enable;
+        }
+
+        /**
+         * @brief       per level statistics of all the BFS runs executed so far
+         * @note        filled only if enabled through enableLevelStats()
+         */
+        const std::vector<bfsLevelStats>& getLevelStats() const
+        {
+          return levelStats;
+        }
+
+        /**
+         * @brief       enable or disable recording of the component labels during BFS runs
+         */
+        void enableVertexLabels(bool enable = true)
+        {
+          vertexLabelsEnabled = enable;
+        }
+
+        /**
+         * @brief       <vertex, component label> pairs of the vertices visited by the BFS runs so far,
+         *              label of a vertex is the source of the BFS run that visited it
+         * @details     Vertex ids are the ids of the edge list, contiguous ids are translated back
+         *              through the dictionary if one was built
+         * @note        filled only if enabled through enableVertexLabels()
+         */
+        std::vector< std::pair<E, E> > getVertexLabels() const
+        {
+          std::vector< std::pair<E, E> > labels(visitedLabels);
+
+          //Dictionary owners hold the ids in the same block layout as idMapping
+          if(dictionary)
+          {
+            conn::graphGen::idMapping<E> mapping(dictionary->getOwnedIds(), comm);
+            conn::graphGen::translateLabels(labels, &mapping, false);
+          }
+
+          return labels;
+        }
+
+        /**
+         * @brief       MTEPS score of each BFS run executed so far
+         */
+        const std::vector<double>& getMTEPS() const
+        {
+          return MTEPS;
+        }
+
+        /**
+         * @brief             rank 0 appends the per level statistics to a file in csv format,
+         *                    the header is written only to a new or empty file
+         * @param[in] fileName  telemetry file of the run
+         */
+        void writeLevelStats(const std::string &fileName)
+        {
+          if(comm.rank() == 0)
+          {
+            bool newFile;
+            {
+              std::ifstream in(fileName);
+              newFile = !in || in.peek() == std::ifstream::traits_type::eof();
+            }
+
+            std::ofstream f(fileName, std::ios::app);
+
+            if(newFile)
+              f << "bfs_run,level,frontier_nnz,edges_examined,discovered,spmv_ms,ewisemult_ms,removefromhash_ms,modeled_bytes\n";
+
+            for(auto &l : levelStats)
+              f << l.bfsRun << "," << l.level << "," << l.frontierSize << "," << l.edgesExamined << "," << l.discoveredSize << ","
+                << l.timeSpMV << "," << l.timeEWiseMult << "," << l.timeRemoveFromHash << "," << l.modeledBytes << "\n";
+
+            f.close();
+          }
+        }
+
         /**
          * @brief                             Remove the edges corresponding to vertices which have been 
          *                                    covered by BFS
@@ -271,6 +534,13 @@ namespace conn
          */
         void filterEdgeList()
         {
+          //Edge list with non-contiguous ids is filtered through the dictionary
+          if(dictionary)
+          {
+            filterEdgeListUsingDictionary();
+            return;
+          }
+
           //Exscan of vertex count kept on previous ranks
           E offsetForLocalToGlobal = mxx::exscan(localDistVecSize, comm);
 
@@ -289,7 +559,9 @@ namespace conn
 
             //Globally sort all the edges by SRC layer
             //Should be quick as edgeList was latest sorted by SRC while reducing ids
-            if(!mxx::is_sorted(edgeList.begin(), edgeList.end(), conn::utils::TpleComp<SRC>(), comm))
+            if(adjacency)
+              adjacency->template sortBy<SRC>();
+            else if(!mxx::is_sorted(edgeList.begin(), edgeList.end(), conn::utils::TpleComp<SRC>(), comm))
               mxx::sort(edgeList.begin(), edgeList.end(), conn::utils::TpleComp<SRC>(), comm);
 
             //Define the splitters using the first SRC element of the edge
@@ -332,12 +604,16 @@ namespace conn
                 for(auto it = unVisitedVerticesArray.begin(); it != unVisitedVerticesArray.end(); it++)
                 {
                   //Edges whose SRC element equals the unvisited vertex element
-                  auto edgeListRange = conn::utils::findRange(it2, edgeList.end(), *it, conn::utils::TpleComp<SRC>()); 
+                  auto rangeBegin = std::lower_bound(it2, edgeList.end(), *it, conn::utils::TpleComp<SRC>());
+                  auto rangeEnd = rangeBegin;
+
+                  if(rangeBegin != edgeList.end() && std::get<SRC>(*rangeBegin) == *it)
+                    rangeEnd = conn::utils::findRunEnd(rangeBegin, edgeList.end(), conn::utils::TpleComp<SRC>());
 
                   //Insert these edges to our new edgeList
-                  edgeListNew.insert(edgeListNew.end(), edgeListRange.first, edgeListRange.second);
+                  edgeListNew.insert(edgeListNew.end(), rangeBegin, rangeEnd);
 
-                  it2 = edgeListRange.second;
+                  it2 = rangeEnd;
                 }
             }); //End of lambda function
 
@@ -351,6 +627,10 @@ namespace conn
             mxx::distribute_inplace(edgeList, comm);
           });
 
+          //Remaining edges are still sorted by SRC, but may not be spread over all the ranks
+          if(adjacency)
+            adjacency->markModified(0);
+
           auto newEdgeListSize = graphGen::globalSizeOfVector(edgeList, comm);;
           LOG_IF(comm.rank() == 0, INFO) << "Edge count remaining after BFS " << newEdgeListSize;
 
@@ -358,31 +638,240 @@ namespace conn
 
         private:
 
+        /**
+         * @brief                             builds the adjacency matrix, vertex degrees and the 
+         *                                    set of unvisited vertices
+         * @param[in] contiguousEdgeList      edges with vertex ids in [0, vertexCount)
+         */
+        void buildAdjacencyMatrix(const std::vector< std::pair<E, E> > &contiguousEdgeList, std::size_t vertexCount)
+        {
+          nVertices = vertexCount;
+
+          //List of edges, distributed in 1D fashion
+          DistEdgeList<E> *DEL = new DistEdgeList<E>();
+
+          //Copy our edgeList to CombBLAS format of edgeList
+          DEL->GenGraphData(contiguousEdgeList, vertexCount);
+
+          comm.barrier();
+
+          integerMatrixType *G = new integerMatrixType(*DEL, false); 
+          delete DEL;	// free memory
+
+          comm.barrier();
+
+          //Compute the vertex degrees
+          G->Reduce(degrees, Row, plus<E>(), static_cast<E>(0));	// Identity is 0 
+
+          //Sum of degrees, same unit as the edge count traversed by each BFS
+          totalEdgeCount = degrees.Reduce(plus<E>(), static_cast<E>(0));
+
+          comm.barrier();
+
+          //Now represent the adj matrix in the boolean format
+          A =  booleanMatrixType(*G);			// Convert to Boolean
+          delete G;
+
+          //Copied the statement from TopDownBFS code
+          //Some kind of optimization for graph500 graphs is expected here
+          A.OptimizeForGraph500(optbuf);		          
+
+          comm.barrier();
+
+          //Helper to initialize the unvisited vertices buffer
+          FullyDistVec<E,E> tmp(A.getcommgrid(), A.getncol(), (E)-1);
+
+          //Record the local array size
+          localDistVecSize = tmp.LocArrSize();
+
+          for(E i = 0; i < tmp.LocArrSize(); i++)
+          {
+            //Note that we are saving local id of every vertex
+            //This gets convenient when we erase the visited elements later
+            unVisitedVertices.emplace(i);
+          }
+
+          //Degrees vector follows the same distribution as the parents array
+          assert(degrees.LocArrSize() == localDistVecSize);
+
+          //Order local vertices by degree, so that BFS sources are high degree vertices
+          sourceCandidates.resize(localDistVecSize);
+          std::iota(sourceCandidates.begin(), sourceCandidates.end(), 0);
+          std::sort(sourceCandidates.begin(), sourceCandidates.end(), [&](const E &v1, const E &v2){
+              E d1 = degrees.GetLocalElement(v1), d2 = degrees.GetLocalElement(v2);
+              return d1 > d2 || (d1 == d2 && v1 < v2);
+              });
+
+          comm.barrier();
+
+          //Print the size of map
+          auto localSize = unVisitedVertices.size();
+          auto totalSize = mxx::reduce(localSize, 0, std::plus<size_t>(), comm); 
+          LOG_IF(comm.rank() == 0, INFO) << "BFS_DEBUG size of map -> " << totalSize;
+        }
+
+        /**
+         * @brief             Remove the edges whose SRC vertex has been covered by BFS, when
+         *                    the edge list uses non-contiguous ids
+         * @details           Each rank asks the owners of its vertices in the parents array
+         *                    (block distributed by contiguous id) whether they are still unvisited,
+         *                    using a single request/response all2all of the unique vertex ids.
+         *                    The edge list is not sorted. Edges are rebalanced after the removal,
+         *                    so the local lookup of the dictionary is rebuilt for the next filter.
+         */
+        void filterEdgeListUsingDictionary()
+        {
+          const int SRC = 0;
+
+          //Exscan of vertex count kept on previous ranks
+          E offsetForLocalToGlobal = mxx::exscan(localDistVecSize, comm);
+          if(!comm.rank()) offsetForLocalToGlobal = 0;
+
+          //Beginning of every rank's portion of the parents array
+          std::vector<E> distVecOffsets = mxx::allgather(offsetForLocalToGlobal, comm);
+
+          //<contiguous id, index in lookup table> of the vertices in local edges
+          const auto &localLookup = dictionary->getLocalLookup();
+
+          std::vector< std::pair<E, std::size_t> > queries(localLookup.size());
+          for(std::size_t i = 0; i < localLookup.size(); i++)
+            queries[i] = std::make_pair(localLookup[i].second, i);
+
+          //Bucket the queries by the rank holding the vertex in the parents array
+          std::vector<std::size_t> sendCounts = mxx::bucketing(queries, [&](const std::pair<E, std::size_t> &q){
+              return std::distance(distVecOffsets.begin(), std::upper_bound(distVecOffsets.begin(), distVecOffsets.end(), q.first)) - 1;
+              }, comm.size());
+
+          std::vector<std::size_t> recvCounts = mxx::all2all(sendCounts, comm);
+
+          std::vector<E> queryIds(queries.size());
+          std::transform(queries.begin(), queries.end(), queryIds.begin(), [](const std::pair<E, std::size_t> &q){ return q.first; });
+
+          auto receivedIds = mxx::all2allv(queryIds, sendCounts, comm);
+
+          //Answer with 1 if the vertex is still unvisited
+          std::vector<uint8_t> answers(receivedIds.size());
+          for(std::size_t i = 0; i < receivedIds.size(); i++)
+            answers[i] = unVisitedVertices.find(receivedIds[i] - offsetForLocalToGlobal) != unVisitedVertices.end();
+
+          auto responses = mxx::all2allv(answers, recvCounts, comm);
+
+          //Mark unvisited vertices, indexed same as the lookup table
+          std::vector<uint8_t> isUnvisited(localLookup.size());
+          for(std::size_t i = 0; i < queries.size(); i++)
+            isUnvisited[queries[i].second] = responses[i];
+
+          //Keep the edges with unvisited SRC vertex
+          auto newEnd = std::remove_if(edgeList.begin(), edgeList.end(), [&](const std::pair<E,E> &e){
+              auto it = std::lower_bound(localLookup.begin(), localLookup.end(), std::make_pair(std::get<SRC>(e), std::numeric_limits<E>::min()));
+
+              //Vertices missing from the lookup table are unknown to this rank, the edge is kept
+              if(it == localLookup.end() || it->first != std::get<SRC>(e))
+                return false;
+
+              return isUnvisited[std::distance(localLookup.begin(), it)] == 0;
+              });
+
+          edgeList.erase(newEnd, edgeList.end());
+
+          comm.with_subset(edgeList.size() > 0, [&](const mxx::comm& comm){
+            //Ensure the block decomposition of edgeList
+            mxx::distribute_inplace(edgeList, comm);
+          });
+
+          //Local vertices changed along with the edges
+          dictionary->updateLocalLookup(edgeList);
+
+          //Removal keeps the relative order of the edges
+          if(adjacency)
+            adjacency->markModified(adjacency->getPrimaryLayer(), adjacency->getSecondaryLayer());
+
+          auto newEdgeListSize = mxx::allreduce(edgeList.size(), comm);
+          LOG_IF(comm.rank() == 0, INFO) << "Edge count remaining after BFS " << newEdgeListSize;
+        }
+
+        /**
+         * @brief             sum of degrees of the vertices in the frontier
+         */
+        E countEdgesOfFrontier(const FullyDistSpVec<E, E> &fringe)
+        {
+          FullyDistSpVec<E, E> fringeOnes(fringe);
+          fringeOnes.Apply(myset<E>(1));
+
+          return EWiseMult(fringeOnes, degrees, false, (E) 0).Reduce(plus<E>(), (E) 0);
+        }
+
+        /**
+         * @brief             reduce the level timings of a BFS run across ranks, model 
+         *                    the communication volume and append to levelStats
+         */
+        void saveLevelStats(std::vector<bfsLevelStats> &thisRunLevelStats)
+        {
+          std::vector<double> times;
+          for(auto &l : thisRunLevelStats)
+          {
+            times.push_back(l.timeSpMV);
+            times.push_back(l.timeEWiseMult);
+            times.push_back(l.timeRemoveFromHash);
+          }
+
+          //Slowest rank decides the time of each step
+          times = mxx::allreduce(times, mxx::max<double>(), comm);
+
+          std::size_t gridRows = A.getcommgrid()->GetGridRows();
+          std::size_t gridCols = A.getcommgrid()->GetGridCols();
+
+          for(std::size_t i = 0; i < thisRunLevelStats.size(); i++)
+          {
+            auto &l = thisRunLevelStats[i];
+
+            l.timeSpMV = times[3*i];
+            l.timeEWiseMult = times[3*i + 1];
+            l.timeRemoveFromHash = times[3*i + 2];
+
+            //Frontier gathered along columns, newly discovered entries merged along rows
+            l.modeledBytes = 2 * sizeof(E) * (l.frontierSize * (gridCols - 1) + l.discoveredSize * (gridRows - 1));
+
+            levelStats.push_back(l);
+          }
+        }
+
         /**
          * @brief             returns next source to start the BFS iterations
          * @param[in] offset  its the value addition required to convert local
          *                    ids in unVisitedVertices to global vertex ids
+         * @details           picks the unvisited vertex with the highest degree (ties are broken
+         *                    with the minimum id). High degree vertices most likely belong to 
+         *                    the giant component, which is what BFS should cover first
          */
         E getSource(E offset)
         {
-          //get candidate from this rank
-          E firstLocalElement;
+          //Skip over the candidates that were visited by earlier BFS runs
+          while(sourceCandidatesPos < sourceCandidates.size() && 
+              unVisitedVertices.find(sourceCandidates[sourceCandidatesPos]) == unVisitedVertices.end())
+            sourceCandidatesPos++;
 
-          if(unVisitedVertices.empty())
+          //get <degree, global id> candidate from this rank
+          std::pair<E, E> localCandidate;
+
+          if(sourceCandidatesPos == sourceCandidates.size())
           {
-            //Set to MAX if the map is empty
-            firstLocalElement = MAX;
+            //Set to MAX if all local vertices are visited
+            localCandidate = std::make_pair(static_cast<E>(-1), MAX);
           }
           else
           {
             //Convert local to global index if we found valid candidate
-            firstLocalElement = *unVisitedVertices.begin() + offset;
+            E v = sourceCandidates[sourceCandidatesPos];
+            localCandidate = std::make_pair(degrees.GetLocalElement(v), v + offset);
           }
 
-          //Find the minimum candidate among all
-          //TODO Should we randomize this selection?
-          E source = mxx::allreduce(firstLocalElement, mxx::min<E>(), comm);
-          return source;
+          //Find the highest degree candidate among all
+          auto globalCandidate = mxx::allreduce(localCandidate, [](const std::pair<E,E> &c1, const std::pair<E,E> &c2){
+              return (c1.first > c2.first || (c1.first == c2.first && c1.second < c2.second)) ? c1 : c2;
+              }, comm);
+
+          return globalCandidate.second;
         }
       };
 
@@ -28,6 +28,8 @@
 
 //Includes
 #include <iostream>
+#include <algorithm>
+#include <functional>
 
 //Own includes
 #include "coloring/labelProp_utils.hpp"
@@ -161,33 +163,31 @@ namespace conn
               std::pair<E,E> middlePc (0,0);    //Internal partition in this rank (not at the boundaries)
               std::pair<E,E> lastPc(0,0);
 
-              for(auto it = tupleVector.begin(); it != tupleVector.end();)
-              {
-                auto equalPcRange = conn::utils::findRange(it, tupleVector.end(), *it, conn::utils::TpleComp<cclTupleIds::Pc>()); 
+              using Iterator = typename std::vector<T>::iterator;
 
-                auto pcSize = std::distance(equalPcRange.first, equalPcRange.second);
+              conn::utils::forEachRun<cclTupleIds::Pc>(tupleVector.begin(), tupleVector.end(), [&](Iterator pcBegin, Iterator pcEnd)
+              {
+                auto pcSize = std::distance(pcBegin, pcEnd);
 
-                if(equalPcRange.first == tupleVector.begin())   //First bucket
+                if(pcBegin == tupleVector.begin())   //First bucket
                 {
-                  firstPc.first = std::get<cclTupleIds::Pc>(*it);
+                  firstPc.first = std::get<cclTupleIds::Pc>(*pcBegin);
                   firstPc.second = pcSize;
                 }
-                else if(equalPcRange.first != tupleVector.begin() && equalPcRange.second == tupleVector.end())   //Last bucket (and different from first bucket)
+                else if(pcBegin != tupleVector.begin() && pcEnd == tupleVector.end())   //Last bucket (and different from first bucket)
                 {
-                  lastPc.first = std::get<cclTupleIds::Pc>(*it);
+                  lastPc.first = std::get<cclTupleIds::Pc>(*pcBegin);
                   lastPc.second = pcSize;
                 }
                 else
                 {
                   if(pcSize > middlePc.second)
                   {
-                    middlePc.first = std::get<cclTupleIds::Pc>(*it);
+                    middlePc.first = std::get<cclTupleIds::Pc>(*pcBegin);
                     middlePc.second = pcSize;
                   }
                 }
-
-                it = equalPcRange.second;
-              }
+              });
               
               if(firstPc.second > 0) partitionSizeVector.push_back(firstPc);
               if(middlePc.second > 0) partitionSizeVector.push_back(middlePc);
@@ -200,21 +200,18 @@ namespace conn
               {
                 const int PcLayer = 0, sizeLayer = 1;
 
-                for(auto it = globalPartitionSizeVector.begin(); it != globalPartitionSizeVector.end();)
-                {
-                  //Pairs corresponding to same Pc
-                  auto equalPcRange = conn::utils::findRange(it, globalPartitionSizeVector.end(), *it, conn::utils::TpleComp<PcLayer>());
+                using PairIterator = typename std::vector<std::pair<E,E>>::iterator;
 
-                  auto thisSize = std::accumulate(equalPcRange.first, equalPcRange.second, static_cast<E>(0), [&](const E &p1, const std::pair<E,E> &p2){
+                //Pairs corresponding to same Pc
+                conn::utils::forEachRun<PcLayer>(globalPartitionSizeVector.begin(), globalPartitionSizeVector.end(), [&](PairIterator pcBegin, PairIterator pcEnd)
+                {
+                  auto thisSize = std::accumulate(pcBegin, pcEnd, static_cast<E>(0), [&](const E &p1, const std::pair<E,E> &p2){
                       return p1 + std::get<sizeLayer>(p2);
                       });
 
                   if(thisSize > largestComponentSize)
                     largestComponentSize = thisSize;
-
-
-                  it = equalPcRange.second;
-                }
+                });
               }
           });
 
@@ -224,6 +221,43 @@ namespace conn
         }
 
 
+        /**
+         * @brief     component label of every vertex
+         * @return    <vertex id, component label> pairs, a vertex appears once across all ranks
+         * @details   label is the id of a vertex in the same component. Tuples of a vertex 
+         *            may lie on several ranks, so the pairs are sorted globally and the 
+         *            duplicates across rank boundaries are removed
+         * @note      should be called after computing connected components. 
+         */
+        std::vector<std::pair<nodeIdType, nodeIdType>> getVertexLabels()
+        {
+          using labelPair = std::pair<nodeIdType, nodeIdType>;
+
+          std::vector<labelPair> labels;
+          labels.reserve(tupleVector.size());
+
+          for(auto &e : tupleVector)
+            labels.emplace_back(std::get<cclTupleIds::nId>(e), std::get<cclTupleIds::Pc>(e));
+
+          //Tuples of a vertex share the same Pc after convergence
+          std::sort(labels.begin(), labels.end());
+          labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+
+          //Bring the copies held by different ranks next to each other
+          mxx::sort(labels.begin(), labels.end(), std::less<labelPair>(), comm);
+          labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+
+          //A run of equal pairs may still span ranks, keep its first copy only
+          comm.with_subset(labels.size() > 0, [&](const mxx::comm& comm){
+              labelPair prevRanksLastLabel = mxx::right_shift(labels.back(), comm);
+
+              if(comm.rank() > 0 && labels.front() == prevRanksLastLabel)
+                labels.erase(labels.begin());
+              });
+
+          return labels;
+        }
+
       private:
 
         /**
@@ -380,32 +414,27 @@ namespace conn
               auto nextMaxPc = mxx::exscan(maxPcOfFirstBucket,  conn::utils::TpleReduce2Layers<cclTupleIds::nId, cclTupleIds::Pc, std::less, std::greater>(), com.reverse()); 
 
               //Now we can update the Pn layer of all the buckets locally
-              for(auto it = begin; it !=  end;)
+              //Buckets are the ranges of tuples with the same node id, along with their min and max Pc
+              conn::utils::forEachRunMinMax<cclTupleIds::nId, cclTupleIds::Pc>(begin, end, [&](Iterator bucketBegin, Iterator bucketEnd, Iterator minPcIt, Iterator maxPcIt)
               {
-                //Range of tuples with the same node id
-                auto equalRange = conn::utils::findRange(it, end, *it, conn::utils::TpleComp<cclTupleIds::nId>());
-
-                //Range would include atleast 1 element
-                assert(std::distance(equalRange.first, equalRange.second) > 0);
-
                 //Minimum Pc from local bucket
-                auto thisBucketsMinPcLocal = mxx::local_reduce(equalRange.first, equalRange.second, conn::utils::TpleReduce<cclTupleIds::Pc>());
+                T thisBucketsMinPcLocal = *minPcIt;
 
                 //Maximum Pc from local bucket
-                auto thisBucketsMaxPcLocal = mxx::local_reduce(equalRange.first, equalRange.second, conn::utils::TpleReduce<cclTupleIds::Pc, std::greater>());
+                T thisBucketsMaxPcLocal = *maxPcIt;
 
                 //For now, mark global minimum as local
                 auto thisBucketsMaxPcGlobal = thisBucketsMaxPcLocal;
                 auto thisBucketsMinPcGlobal = thisBucketsMinPcLocal;
 
                 //Treat first, last buckets as special cases
-                if(equalRange.first == begin)
+                if(bucketBegin == begin)
                 {
                   //Use value from previous rank
                   thisBucketsMinPcGlobal =  com.rank() == 0 ? thisBucketsMinPcLocal : conn::utils::TpleReduce2Layers<cclTupleIds::nId, cclTupleIds::Pc, std::greater, std::less>() (prevMinPc, thisBucketsMinPcLocal);
                 }
 
-                if(equalRange.second == end)
+                if(bucketEnd == end)
                 {
                   //Use value from next rank
                   thisBucketsMaxPcGlobal = com.rank() == com.size() - 1 ? thisBucketsMaxPcLocal : conn::utils::TpleReduce2Layers<cclTupleIds::nId, cclTupleIds::Pc, std::less, std::greater>() (nextMaxPc, thisBucketsMaxPcLocal);
@@ -413,21 +442,18 @@ namespace conn
                 }
 
                 auto maxPcValue = std::get<cclTupleIds::Pc>(thisBucketsMaxPcGlobal);
-                auto minPcValue = std::min(std::get<cclTupleIds::Pc>(thisBucketsMinPcGlobal), std::get<cclTupleIds::nId>(*equalRange.first));
+                auto minPcValue = std::min(std::get<cclTupleIds::Pc>(thisBucketsMinPcGlobal), std::get<cclTupleIds::nId>(*bucketBegin));
 
                 //If min Pc < max Pc for this bucket, update Pn or else mark them as stable
                 if(minPcValue < maxPcValue)
-                  std::for_each(equalRange.first, equalRange.second, [&](T &e){
+                  std::for_each(bucketBegin, bucketEnd, [&](T &e){
                       std::get<cclTupleIds::Pn>(e) = minPcValue;
                       });
                 else
-                  std::for_each(equalRange.first, equalRange.second, [&](T &e){
+                  std::for_each(bucketBegin, bucketEnd, [&](T &e){
                       std::get<cclTupleIds::Pn>(e) = MAX_PID2;
                       });
-
-                //Advance the loop pointer
-                it = equalRange.second;
-              }
+              });
           });
         }
 
@@ -461,22 +487,17 @@ namespace conn
 
 
                 //Now we can update the Pc layer of all the buckets locally
-                for(auto it = begin; it !=  end;)
+                //Buckets are the ranges of tuples with the same Pc, along with their min Pn
+                conn::utils::forEachRunMinMax<cclTupleIds::Pc, cclTupleIds::Pn>(begin, end, [&](Iterator bucketBegin, Iterator bucketEnd, Iterator minPnIt, Iterator)
                 {
-                  //Range of tuples with the same Pc
-                  auto equalRange = conn::utils::findRange(it, end, *it, conn::utils::TpleComp<cclTupleIds::Pc>());
-
-                  //Range would include atleast 1 element
-                  assert(std::distance(equalRange.first, equalRange.second) > 0);
-
                   //Minimum Pn from local bucket
-                  auto thisBucketsMinPnLocal = mxx::local_reduce(equalRange.first, equalRange.second, conn::utils::TpleReduce<cclTupleIds::Pn>());
+                  T thisBucketsMinPnLocal = *minPnIt;
 
                   //For now, mark global minimum as local
                   auto thisBucketsMinPnGlobal = thisBucketsMinPnLocal;
 
                   //Treat first, last buckets as special cases
-                  if(equalRange.first == begin)
+                  if(bucketBegin == begin)
                   {
                     //Use value from previous rank
                     thisBucketsMinPnGlobal =  com.rank() == 0 ?  thisBucketsMinPnLocal : 
@@ -491,7 +512,7 @@ namespace conn
                     converged = 0;
 
                     //Update Pc
-                    std::for_each(equalRange.first, equalRange.second, [&](T &e){
+                    std::for_each(bucketBegin, bucketEnd, [&](T &e){
                         std::get<cclTupleIds::Pc>(e) = std::get<cclTupleIds::Pn>(thisBucketsMinPnGlobal);
                         });
 
@@ -502,14 +523,11 @@ namespace conn
                   else
                   {
                     //stable
-                    std::for_each(equalRange.first, equalRange.second, [&](T &e){
+                    std::for_each(bucketBegin, bucketEnd, [&](T &e){
                         std::get<cclTupleIds::Pn>(e) = MAX_PID;
                         });
                   }
-
-                  //Advance the loop pointer
-                  it = equalRange.second;
-                }
+                });
 
             });
 
@@ -540,6 +558,8 @@ namespace conn
          */
         void doPointerDoubling(std::size_t &beginOffset, std::vector<T>& parentRequestTupleVector)
         {
+          using Iterator = typename std::vector<T>::iterator;
+
           //Copy the tuples from parentRequestTupleVector to tupleVector 
           tupleVector.insert(tupleVector.end(), parentRequestTupleVector.begin(), parentRequestTupleVector.end());
 
@@ -564,18 +584,17 @@ namespace conn
               mxx::sort(begin, end, conn::utils::TpleComp2Layers<cclTupleIds::nId, cclTupleIds::Pc>(), com); 
               auto minPcOfLastBucket = mxx::local_reduce(begin, end, conn::utils::TpleReduce2Layers<cclTupleIds::nId, cclTupleIds::Pc, std::greater, std::less>());
               auto prevMinPc = mxx::exscan(minPcOfLastBucket, conn::utils::TpleReduce2Layers<cclTupleIds::nId, cclTupleIds::Pc, std::greater, std::less>(), com);  
-              for(auto it = begin; it !=  end;)
+              conn::utils::forEachRunMinMax<cclTupleIds::nId, cclTupleIds::Pc>(begin, end, [&](Iterator bucketBegin, Iterator bucketEnd, Iterator minPcIt, Iterator)
               {
-                auto equalRange = conn::utils::findRange(it, end, *it, conn::utils::TpleComp<cclTupleIds::nId>());
-                auto thisBucketsMinPcLocal = mxx::local_reduce(equalRange.first, equalRange.second, conn::utils::TpleReduce<cclTupleIds::Pc>());
+                T thisBucketsMinPcLocal = *minPcIt;
                 auto thisBucketsMinPcGlobal = thisBucketsMinPcLocal;
-                if(equalRange.first == begin)
+                if(bucketBegin == begin)
                 {
                   thisBucketsMinPcGlobal =  com.rank() == 0 ? thisBucketsMinPcLocal : 
                   conn::utils::TpleReduce2Layers<cclTupleIds::nId, cclTupleIds::Pc, std::greater, std::less>() (prevMinPc, thisBucketsMinPcLocal);
                 }
 
-                std::for_each(equalRange.first, equalRange.second, [&](T &e)
+                std::for_each(bucketBegin, bucketEnd, [&](T &e)
                 {
                   if(std::get<cclTupleIds::Pc>(e) == MAX_PID)
                   {
@@ -586,20 +605,17 @@ namespace conn
                     std::get<cclTupleIds::nId>(e) =  MAX_NID;
                   }
                 });
-
-                it = equalRange.second;
-              }
+              });
 
               //2. Now repeat the procedure of updatePc()
               mxx::sort(begin, end, conn::utils::TpleComp2Layers<cclTupleIds::Pc, cclTupleIds::Pn>(), com); 
               auto minPnOfLastBucket = mxx::local_reduce(begin, end, conn::utils::TpleReduce2Layers<cclTupleIds::Pc, cclTupleIds::Pn, std::greater, std::less>());
               auto prevMinPn = mxx::exscan(minPnOfLastBucket, conn::utils::TpleReduce2Layers<cclTupleIds::Pc, cclTupleIds::Pn, std::greater, std::less>(), com);  
-              for(auto it = begin; it !=  end;)
+              conn::utils::forEachRunMinMax<cclTupleIds::Pc, cclTupleIds::Pn>(begin, end, [&](Iterator bucketBegin, Iterator bucketEnd, Iterator minPnIt, Iterator)
               {
-                auto equalRange = conn::utils::findRange(it, end, *it, conn::utils::TpleComp<cclTupleIds::Pc>());
-                auto thisBucketsMinPnLocal = mxx::local_reduce(equalRange.first, equalRange.second, conn::utils::TpleReduce<cclTupleIds::Pn>());
+                T thisBucketsMinPnLocal = *minPnIt;
                 auto thisBucketsMinPnGlobal = thisBucketsMinPnLocal;
-                if(equalRange.first == begin)
+                if(bucketBegin == begin)
                 {
                   thisBucketsMinPnGlobal =  com.rank() == 0 ?  thisBucketsMinPnLocal : 
                     conn::utils::TpleReduce2Layers<cclTupleIds::Pc, cclTupleIds::Pn, std::greater, std::less>() (prevMinPn, thisBucketsMinPnLocal);
@@ -608,13 +624,11 @@ namespace conn
 
                 //update the Pc for pointer jumping
                 //Ignore the stable partitions
-                if(std::get<cclTupleIds::Pn>(*equalRange.first) != MAX_PID)
-                  std::for_each(equalRange.first, equalRange.second, [&](T &e){
+                if(std::get<cclTupleIds::Pn>(*bucketBegin) != MAX_PID)
+                  std::for_each(bucketBegin, bucketEnd, [&](T &e){
                       std::get<cclTupleIds::Pc>(e) = std::get<cclTupleIds::Pn>(thisBucketsMinPnGlobal);
                       });
-
-                it = equalRange.second;
-              }
+              });
           });
 
 
@@ -0,0 +1,311 @@
+/*
+ * Copyright 2016 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    costModel.hpp
+ * @ingroup dynamic
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ * @brief   Predicts the runtime of the connectivity plans using calibrated machine
+ *          throughput and cheap graph statistics, and picks the cheapest plan
+ *
+ * Copyright (c) 2016 Georgia Institute of Technology. All Rights Reserved.
+ */
+
+#ifndef GRAPH_COST_MODEL_HPP
+#define GRAPH_COST_MODEL_HPP
+
+//Includes
+#include <mpi.h>
+#include <iostream>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <numeric>
+#include <cmath>
+
+//Own includes
+#include "dynamic/degreeDistInfo.hpp"
+#include "graphGen/common/sortedAdjacency.hpp"
+
+//External includes
+#include "extutils/logging.hpp"
+#include "mxx/collective.hpp"
+#include "mxx/reduction.hpp"
+#include "mxx/sort.hpp"
+
+namespace conn
+{
+  namespace dynamic
+  {
+
+    /**
+     * @brief     Throughput of the communication heavy primitives on this machine
+     * @details   Costs are per 64-bit word held by each rank, in nanoseconds
+     */
+    struct machineCalibration
+    {
+      double sortNsPerWord;
+      double all2allNsPerWord;
+    };
+
+    /**
+     * @brief     Constants of the cost model
+     * @details   Defaults describe the implementations in this repository: ccl sorts
+     *            3-word tuples twice per iteration, and twice more for pointer doubling,
+     *            while the active set shrinks as partitions become stable.
+     *            These are uncalibrated priors, read off the algorithms and not fitted to
+     *            measured ccl or BFS runs. Only the machine throughput (machineCalibration)
+     *            is measured, so the predicted times are estimates of the relative cost of
+     *            the plans, and the choice near the break-even point is not reliable.
+     */
+    struct costModelParameters
+    {
+      //Sorts of the tuple vector per coloring iteration (Pn, Pc updates and doubling)
+      double sortsPerColoringIteration = 4.0;
+
+      //Average fraction of tuples active during an iteration
+      double activeTupleFraction = 0.5;
+
+      //Coloring iterations are modeled as coloringIterationBase + log2(|V|) * coloringIterationSlope
+      double coloringIterationBase = 2.0;
+      double coloringIterationSlope = 0.5;
+
+      //Words communicated per edge traversed by the BFS (SpMV gather and scatter of <index, value>)
+      double bfsWordsPerEdge = 4.0;
+    };
+
+    /**
+     * @brief     Connectivity plans the planner chooses from
+     * @details   bfsThenColoring is the hybrid plan, BFS runs are stopped once the components 
+     *            get small (see runBFSIterationsAdaptive()) and ccl finishes the rest. A BFS only 
+     *            plan, or a choice between the coloring engines (e.g. with or without pointer 
+     *            doubling), is not modeled
+     */
+    enum connectivityPlan
+    {
+      coloringOnly,       //ccl over the complete graph
+      bfsThenColoring     //BFS over the giant component, ccl over the rest
+    };
+
+    /**
+     * @brief     Predicted runtimes (ms) of all the plans, and the cheapest one
+     */
+    struct planPrediction
+    {
+      connectivityPlan plan;
+      double coloringOnlyTime;
+      double bfsThenColoringTime;
+
+      double predictedTime() const
+      {
+        return plan == coloringOnly ? coloringOnlyTime : bfsThenColoringTime;
+      }
+    };
+
+    /**
+     * @brief                     runs quick sort and all2all probes over random 64-bit values
+     *                            (same as time_sort.cpp and time_all2all.cpp)
+     * @param[in] probeSize       count of values per rank, rounded down to a multiple of the count of ranks
+     * @return                    calibration, using the time of the slowest rank
+     */
+    inline machineCalibration calibrateMachine(mxx::comm &comm, std::size_t probeSize = 1UL << 20)
+    {
+      using valueType = int64_t;
+
+      //all2all sends an equal share of the buffer to every rank
+      probeSize = std::max<std::size_t>(comm.size(), probeSize - probeSize % comm.size());
+
+      std::vector<valueType> buffer(probeSize);
+
+      std::mt19937_64 gen(comm.rank());
+      std::generate(buffer.begin(), buffer.end(), gen);
+
+      machineCalibration calibration;
+
+      //Sort probe
+      {
+        comm.barrier();
+        auto start = std::chrono::steady_clock::now();
+
+        mxx::sort(buffer.begin(), buffer.end(), comm);
+
+        auto end = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double, std::nano>(end - start).count();
+
+        calibration.sortNsPerWord = mxx::allreduce(elapsed, mxx::max<double>(), comm) / probeSize;
+      }
+
+      //All2all probe
+      {
+        comm.barrier();
+        auto start = std::chrono::steady_clock::now();
+
+        auto bufferRecvd = mxx::all2all(buffer, comm);
+
+        auto end = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double, std::nano>(end - start).count();
+
+        calibration.all2allNsPerWord = mxx::allreduce(elapsed, mxx::max<double>(), comm) / probeSize;
+      }
+
+      LOG_IF(!comm.rank(), INFO) << "Calibration : sort " << calibration.sortNsPerWord << " ns/word, all2all " << calibration.all2allNsPerWord << " ns/word";
+
+      return calibration;
+    }
+
+    /**
+     * @brief                     fraction of edges in the giant component of a random graph
+     *                            with the given degree distribution (configuration model)
+     * @param[in] histogram       <degree, frequency> pairs
+     * @details                   u, the probability that an edge end does not lead to the giant
+     *                            component, is the smallest fixed point of u = G1(u), where G1 is the
+     *                            generating function of the excess degree. An edge is outside the giant
+     *                            component if neither of its ends leads to it, i.e. with probability u^2
+     */
+    inline double giantComponentEdgeFraction(const std::vector<std::pair<std::size_t, double>> &histogram)
+    {
+      double edgeEnds = 0;
+      for(auto &h : histogram)
+        edgeEnds += h.first * h.second;
+
+      if(edgeEnds == 0)
+        return 0;
+
+      double u = 0;
+
+      for(int iter = 0; iter < 1000; iter++)
+      {
+        //G1(u) = sum k p_k u^(k-1) / <k>
+        double g1 = 0;
+        for(auto &h : histogram)
+          g1 += h.first * h.second * std::pow(u, h.first - 1.0);
+        g1 /= edgeEnds;
+
+        if(std::abs(g1 - u) < 1e-9)
+          break;
+
+        u = g1;
+      }
+
+      return 1.0 - u*u;
+    }
+
+    /**
+     * @brief                     predicted runtimes of the connectivity plans for a degree distribution
+     * @param[in] histogram       <degree, frequency> pairs of the graph
+     * @param[in] nEdges          count of edges, each edge counted both ways
+     * @param[in] p               count of ranks
+     * @param[in] calibration     machine throughput, see calibrateMachine()
+     * @details                   Coloring time is the cost of sorting the tuples over all the iterations.
+     *                            BFS plan is the cost of building the id dictionary and the adjacency matrix,
+     *                            traversing the giant component, and coloring over the remaining edges
+     */
+    inline planPrediction predictPlan(const std::vector<std::pair<std::size_t, double>> &histogram, 
+        double nEdges, double p,
+        const machineCalibration &calibration,
+        const costModelParameters &params = costModelParameters())
+    {
+      planPrediction prediction = {};
+
+      double nVertices = std::accumulate(histogram.begin(), histogram.end(), 0.0, 
+          [](double sum, const std::pair<std::size_t, double> &h) { return sum + h.second; });
+      double giantFraction = giantComponentEdgeFraction(histogram);
+
+      //Coloring cost over a graph with given count of edges and vertices
+      auto coloringTime = [&](double edges, double vertices) {
+        if(edges <= 0) return 0.0;
+
+        double iterations = params.coloringIterationBase + params.coloringIterationSlope * std::log2(std::max(2.0, vertices));
+        double tuplesPerRank = (edges + vertices) / p;
+
+        return iterations * params.sortsPerColoringIteration * params.activeTupleFraction *
+          tuplesPerRank * 3 * calibration.sortNsPerWord * 1e-6;
+      };
+
+      prediction.coloringOnlyTime = coloringTime(nEdges, nVertices);
+
+      //Dictionary: vertex ids are sent to owners and back
+      double dictionaryTime = 2 * 2 * (nEdges / p) * calibration.all2allNsPerWord * 1e-6;
+
+      //Adjacency matrix: edges are redistributed and sorted once by CombBLAS
+      double matrixTime = (nEdges / p) * 2 * calibration.sortNsPerWord * 1e-6;
+
+      //Traversal of the giant component
+      double traversalTime = giantFraction * (nEdges / p) * params.bfsWordsPerEdge * calibration.all2allNsPerWord * 1e-6;
+
+      //Filtering of the remaining edges
+      double filterTime = 2 * (nEdges / p) * calibration.all2allNsPerWord * 1e-6;
+
+      prediction.bfsThenColoringTime = dictionaryTime + matrixTime + traversalTime + filterTime +
+        coloringTime((1.0 - giantFraction) * nEdges, (1.0 - giantFraction) * nVertices);
+
+      prediction.plan = prediction.bfsThenColoringTime < prediction.coloringOnlyTime ? bfsThenColoring : coloringOnly;
+
+      LOG(INFO) << "Cost model : estimated vertices " << nVertices << ", giant component edge fraction " << giantFraction;
+      LOG(INFO) << "Cost model : predicted time (ms) of coloring -> " << prediction.coloringOnlyTime
+        << ", BFS + coloring -> " << prediction.bfsThenColoringTime;
+
+      return prediction;
+    }
+
+    /**
+     * @brief                     predicts the runtime of the connectivity plans, and picks the cheapest
+     * @param[in] adjacency       distributed edges, see sortedAdjacency
+     * @param[in] calibration     machine throughput, see calibrateMachine()
+     * @param[in] mode            method to compute degree distribution, sampling is recommended
+     * @details                   Degree histogram is computed by all the ranks, the prediction 
+     *                            (see predictPlan()) is made on rank 0
+     * @NOTE                      Assumes each edge is present both ways in the edgeList vector
+     */
+    template <typename E>
+      planPrediction choosePlan(conn::graphGen::sortedAdjacency<E> &adjacency, mxx::comm &comm,
+          const machineCalibration &calibration,
+          degreeDistMode mode = degreeDistMode::sampled,
+          const costModelParameters &params = costModelParameters())
+      {
+        double nEdges = mxx::allreduce(adjacency.edges().size(), comm);
+
+        auto histogram = computeDegreeHistogram(adjacency, comm, mode);
+
+        planPrediction prediction = {};
+
+        if(!comm.rank())
+          prediction = predictPlan(histogram, nEdges, comm.size(), calibration, params);
+
+        //Everyone follows rank 0
+        int plan = prediction.plan;
+        plan = mxx::bcast(plan, 0, comm);
+        prediction.coloringOnlyTime = mxx::bcast(prediction.coloringOnlyTime, 0, comm);
+        prediction.bfsThenColoringTime = mxx::bcast(prediction.bfsThenColoringTime, 0, comm);
+        prediction.plan = static_cast<connectivityPlan>(plan);
+
+        return prediction;
+      }
+
+    template <typename E>
+      planPrediction choosePlan(std::vector<std::pair<E,E>> &edgeList, mxx::comm &comm,
+          const machineCalibration &calibration,
+          degreeDistMode mode = degreeDistMode::sampled,
+          const costModelParameters &params = costModelParameters())
+      {
+        conn::graphGen::sortedAdjacency<E> adjacency(edgeList, comm);
+        return choosePlan(adjacency, comm, calibration, mode, params);
+      }
+
+  }
+}
+
+#endif
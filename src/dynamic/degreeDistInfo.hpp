@@ -30,14 +30,21 @@
 #include <mpi.h>
 #include <iostream>
 #include <algorithm>
+#include <numeric>
+#include <iterator>
+#include <cmath>
+#include <unordered_map>
 
 //Own includes
 #include "utils/commonfuncs.hpp"
+#include "graphGen/common/idDictionary.hpp"
+#include "graphGen/common/sortedAdjacency.hpp"
 
 //External includes
 #include "mxx/distribution.hpp"
 #include "mxx/reduction.hpp"
 #include "mxx/sort.hpp"
+#include "mxx/algos.hpp"
 #include "plfit/src/plfit.h"
 #include "mxx/timer.hpp"
 
@@ -72,59 +79,53 @@ namespace conn
       }
 
     /**
-     * @brief                   Decides if its optimal to run BFS iteration based on the degree distribution
-     * @param[in]  edgeList     distributed vector of edges
-     * @return                  true if BFS should be executed, false otherwise
-     * @NOTE                    Assumes each edge is present both ways in the edgeList vector         
+     * @brief     method used to compute the degree distribution
+     */
+    enum degreeDistMode
+    {
+      exact,      //sorts the complete edge list, and counts degree of every vertex
+      sampled     //counts degrees of a uniform vertex sample, and of the heavy hitters
+    };
+
+    /**
+     * @brief                   Computes the degree frequency of all vertices by sorting the edge list
+     * @param[in]  adjacency    distributed edges, sorted here by (DEST, SRC) unless already in that order
+     * @param[out] degreeCountMap local contribution to the degree frequencies
      */
     template <typename E>
-      bool runBFSDecision(std::vector<std::pair<E,E>> &edgeList, mxx::comm &comm)
+      void exactDegreeCounts(conn::graphGen::sortedAdjacency<E> &adjacency, std::unordered_map<std::size_t, double> &degreeCountMap, mxx::comm &comm)
       {
-#ifdef BENCHMARK_CONN
-        mxx::section_timer timer(std::cerr, comm);
-#endif
-
         const int SRC = 1, DEST = 0;  //Reverse the layers to avoid sorting during relabeling vertices
 
-        const int sampler = 11;
-
-        //Ensure the block decomposition of edgeList
-        mxx::distribute_inplace(edgeList, comm);
-
         //Sort by source, dest vertex
-        mxx::sort(edgeList.begin(), edgeList.end(), conn::utils::TpleComp2Layers<SRC,DEST>(), comm);
-
-        //Map to hold degree frequency
-        std::unordered_map<std::size_t, std::size_t> degreeCountMap;
+        adjacency.template sortBy<SRC,DEST>();
 
-        std::size_t maxDegree = 0;
+        auto &edgeList = adjacency.edges();
+        const auto &runOffsets = adjacency.getRunOffsets();
 
         //Vector to hold boundary vertex degrees
         std::vector<std::pair<E,E>> boundaryVertexDegrees;
 
-        for(auto it = edgeList.begin(); it != edgeList.end();)
+        for(std::size_t r = 0; r + 1 < runOffsets.size(); r++)
         {
-          auto equalSrcRange = conn::utils::findRange(it, edgeList.end(), *it, conn::utils::TpleComp<SRC>()); 
-
-          //A vertex may have duplicate destination vertices, ignore them
-          auto uniqueDestVerticeIter = std::unique(equalSrcRange.first, equalSrcRange.second);
-
-          auto currentDegree = std::distance(equalSrcRange.first, uniqueDestVerticeIter);
-
-          if(equalSrcRange.first == edgeList.begin())   //First bucket
-            boundaryVertexDegrees.emplace_back(std::get<SRC>(*it), currentDegree);
-          else if(equalSrcRange.second == edgeList.end() && equalSrcRange.first != edgeList.begin())   //Last bucket (and different from first bucket)
-            boundaryVertexDegrees.emplace_back(std::get<SRC>(*it), currentDegree);
+          auto first = edgeList.begin() + runOffsets[r];
+          auto last = edgeList.begin() + runOffsets[r+1];
+
+          //A vertex may have duplicate destination vertices, count them once
+          E currentDegree = 1;
+          for(auto it = std::next(first); it != last; it++)
+            if(std::get<DEST>(*it) != std::get<DEST>(*std::prev(it)))
+              currentDegree++;
+
+          if(r == 0)   //First bucket
+            boundaryVertexDegrees.emplace_back(std::get<SRC>(*first), currentDegree);
+          else if(r + 2 == runOffsets.size())   //Last bucket (and different from first bucket)
+            boundaryVertexDegrees.emplace_back(std::get<SRC>(*first), currentDegree);
           else
           {
             //This bucket is completely local to this rank
             degreeCountMap[currentDegree]++;
-
-            if(currentDegree > maxDegree)
-              maxDegree = currentDegree;
           }
-
-          it = equalSrcRange.second;
         }
 
         auto globalBoundaryVertexDegrees = mxx::gatherv(boundaryVertexDegrees, 0, comm);
@@ -133,33 +134,263 @@ namespace conn
         {
           const int SRC = 0, COUNT = 1;
 
-          for(auto it = boundaryVertexDegrees.begin(); it != boundaryVertexDegrees.end();)
+          using Iterator = typename std::vector<std::pair<E,E>>::iterator;
+
+          conn::utils::forEachRun<SRC>(globalBoundaryVertexDegrees.begin(), globalBoundaryVertexDegrees.end(), [&](Iterator srcBegin, Iterator srcEnd)
           {
-            auto equalSrcRange = conn::utils::findRange(it, globalBoundaryVertexDegrees.end(), *it, conn::utils::TpleComp<SRC>());
-          
-            auto currentDegree = std::accumulate(equalSrcRange.first, equalSrcRange.second, 0, [&](const E &p1, const std::pair<E,E> &p2){
+            auto currentDegree = std::accumulate(srcBegin, srcEnd, 0, [&](const E &p1, const std::pair<E,E> &p2){
                 return p1 + std::get<COUNT>(p2);
                 });
 
-            if(currentDegree > maxDegree)
-              maxDegree = currentDegree;
-
             degreeCountMap[currentDegree]++;
+          });
+        }
+      }
+
+    /**
+     * @brief                   Estimates the degree frequency without sorting the edge list
+     * @param[in]  edgeList     distributed vector of edges
+     * @param[out] degreeCountMap local contribution to the (estimated) degree frequencies
+     * @param[in]  sampleEdgeTarget expected count of edges in the sample
+     * @details                 1. Heavy hitters (frequent SRC vertices) are found on each rank 
+     *                             using Misra-Gries counters, their degrees are counted exactly
+     *                             with an allreduce
+     *                          2. Remaining vertices are sampled uniformly by hashing the vertex id,
+     *                             such that all edges of a sampled vertex are picked. Sampled edges
+     *                             are routed to owner ranks, which count the degrees after removing
+     *                             duplicate edges. Frequencies are scaled by the sampling rate.
+     *                          Only the sample is communicated and sorted locally.
+     *                          Degrees of the heavy hitters include duplicate edges, if present.
+     */
+    template <typename E>
+      void sampledDegreeCounts(std::vector<std::pair<E,E>> &edgeList, std::unordered_map<std::size_t, double> &degreeCountMap, 
+          mxx::comm &comm, std::size_t sampleEdgeTarget)
+      {
+        const int SRC = 1, DEST = 0;  //Same layers as exactDegreeCounts()
+
+        //Count of heavy hitter candidates per rank
+        const std::size_t heavyHitterCounters = 64;
+
+        std::size_t totalEdges = mxx::allreduce(edgeList.size(), comm);
+
+        //Pick 1 in samplingRate vertices
+        uint64_t samplingRate = std::max(static_cast<std::size_t>(1), totalEdges / std::max(static_cast<std::size_t>(1), sampleEdgeTarget));
+
+        //1. Heavy hitters
+        std::vector<E> heavyHitters;
+        {
+          //Misra-Gries summary over local SRC vertices
+          std::unordered_map<E, std::size_t> counters;
+
+          for(auto &e : edgeList)
+          {
+            auto it = counters.find(std::get<SRC>(e));
+
+            if(it != counters.end())
+              it->second++;
+            else if(counters.size() < heavyHitterCounters)
+              counters.emplace(std::get<SRC>(e), 1);
+            else
+            {
+              //Decrement all the counters
+              for(auto c = counters.begin(); c != counters.end();)
+              {
+                if(--(c->second) == 0)
+                  c = counters.erase(c);
+                else
+                  c++;
+              }
+            }
+          }
+
+          std::vector<E> localCandidates;
+          for(auto &c : counters)
+            localCandidates.push_back(c.first);
+
+          heavyHitters = mxx::allgatherv(localCandidates, comm);
+          std::sort(heavyHitters.begin(), heavyHitters.end());
+          heavyHitters.erase(std::unique(heavyHitters.begin(), heavyHitters.end()), heavyHitters.end());
+
+          //Exact counts of the candidates
+          std::vector<std::size_t> heavyHitterDegrees(heavyHitters.size(), 0);
+          for(auto &e : edgeList)
+          {
+            auto it = std::lower_bound(heavyHitters.begin(), heavyHitters.end(), std::get<SRC>(e));
 
-            it = equalSrcRange.second;
+            if(it != heavyHitters.end() && *it == std::get<SRC>(e))
+              heavyHitterDegrees[std::distance(heavyHitters.begin(), it)]++;
           }
+
+          heavyHitterDegrees = mxx::allreduce(heavyHitterDegrees, std::plus<std::size_t>(), comm);
+
+          //Every rank knows the heavy hitters, let rank 0 count them
+          if(comm.rank() == 0)
+            for(auto d : heavyHitterDegrees)
+              degreeCountMap[d]++;
         }
-        
-        maxDegree = mxx::allreduce(maxDegree, mxx::max<std::size_t>(), comm);
 
-        //Convert to vector
-        //Holds the frequency of degrees [1,2..maxDegree]
-        std::vector<double> degreeHolder(maxDegree);
-        for(size_t i = 0; i < degreeHolder.size(); i++)
-          degreeHolder[i] = degreeCountMap[i+1];
+        //2. Uniform sample of the remaining vertices
+        {
+          std::vector<std::pair<E,E>> sampledEdges;
+
+          for(auto &e : edgeList)
+          {
+            uint64_t key = static_cast<uint64_t>(std::get<SRC>(e));
+            conn::graphGen::hash_64(key);
+
+            //Use the higher bits, lower bits decide the owner rank
+            if((key >> 32) % samplingRate == 0 && !std::binary_search(heavyHitters.begin(), heavyHitters.end(), std::get<SRC>(e)))
+              sampledEdges.push_back(e);
+          }
+
+          //Route the edges to the owner of SRC vertex
+          conn::graphGen::vertexToHashOwner<E> vertexRankAssigner(comm.size());
+          mxx::all2all_func(sampledEdges, [&](const std::pair<E,E> &e){ return vertexRankAssigner(std::get<SRC>(e)); }, comm);
+
+          //Local sort, remove duplicate edges
+          std::sort(sampledEdges.begin(), sampledEdges.end(), conn::utils::TpleComp2Layers<SRC,DEST>());
+          sampledEdges.erase(std::unique(sampledEdges.begin(), sampledEdges.end()), sampledEdges.end());
 
-        //Reduce degree vector to rank 0
-        auto globalDegreeCounts = mxx::reduce(degreeHolder, 0, comm);
+          using Iterator = typename std::vector<std::pair<E,E>>::iterator;
+
+          conn::utils::forEachRun<SRC>(sampledEdges.begin(), sampledEdges.end(), [&](Iterator srcBegin, Iterator srcEnd)
+          {
+            degreeCountMap[std::distance(srcBegin, srcEnd)] += samplingRate;
+          });
+
+          std::size_t sampleSize = mxx::reduce(sampledEdges.size(), 0, comm);
+          LOG_IF(!comm.rank(), INFO) << "Degree distribution sampled from " << sampleSize << " edges (1 in " << samplingRate << " vertices) and " << heavyHitters.size() << " heavy hitters";
+        }
+      }
+
+    /**
+     * @brief                   Merges the sparse degree histograms of all ranks to rank 0
+     * @param[in]  histogram    local <degree, frequency> pairs
+     * @return                  merged histogram on rank 0 sorted by degree, empty on other ranks
+     * @details                 Entries are routed to the rank owning their degree (degree mod p), which
+     *                          adds up the frequencies of each degree. Rank 0 then gathers the merged
+     *                          entries, one per distinct degree in the graph. No rank receives more than 
+     *                          p entries per degree it owns.
+     */
+    inline std::vector<std::pair<std::size_t, double>> reduceHistogram(std::vector<std::pair<std::size_t, double>> histogram, const mxx::comm &comm)
+    {
+      using entryType = std::pair<std::size_t, double>;
+
+      mxx::all2all_func(histogram, [&](const entryType &e){ return e.first % comm.size(); }, comm);
+
+      //Add up the frequencies of equal degrees
+      std::sort(histogram.begin(), histogram.end(), conn::utils::TpleComp<0>());
+
+      std::vector<entryType> merged;
+      for(auto &e : histogram)
+      {
+        if(!merged.empty() && merged.back().first == e.first)
+          merged.back().second += e.second;
+        else
+          merged.push_back(e);
+      }
+
+      merged = mxx::gatherv(merged, 0, comm);
+
+      //Degrees are unique across the ranks
+      std::sort(merged.begin(), merged.end(), conn::utils::TpleComp<0>());
+
+      return merged;
+    }
+
+    /**
+     * @brief                   Computes the degree frequencies of the graph
+     * @param[in]  adjacency    distributed edges, sorted order is reused if mode = exact
+     * @param[in]  mode         compute the exact degree distribution, or estimate it from a sample
+     * @param[in]  sampleEdgeTarget expected count of edges in the sample (if mode = sampled)
+     * @return                  on rank 0, <degree, frequency> pairs sorted by degree, empty on other ranks
+     * @NOTE                    Assumes each edge is present both ways in the edgeList vector         
+     */
+    template <typename E>
+      std::vector<std::pair<std::size_t, double>> computeDegreeHistogram(conn::graphGen::sortedAdjacency<E> &adjacency, mxx::comm &comm, 
+          degreeDistMode mode = degreeDistMode::exact, std::size_t sampleEdgeTarget = 1UL << 24)
+      {
+        //Map to hold degree frequency
+        std::unordered_map<std::size_t, double> degreeCountMap;
+
+        if(mode == degreeDistMode::exact)
+          exactDegreeCounts(adjacency, degreeCountMap, comm);
+        else
+          sampledDegreeCounts(adjacency.edges(), degreeCountMap, comm, sampleEdgeTarget);
+
+        //Only the degrees seen on this rank are kept
+        std::vector<std::pair<std::size_t, double>> histogram(degreeCountMap.begin(), degreeCountMap.end());
+
+        return reduceHistogram(histogram, comm);
+      }
+
+    template <typename E>
+      std::vector<std::pair<std::size_t, double>> computeDegreeHistogram(std::vector<std::pair<E,E>> &edgeList, mxx::comm &comm, 
+          degreeDistMode mode = degreeDistMode::exact, std::size_t sampleEdgeTarget = 1UL << 24)
+      {
+        conn::graphGen::sortedAdjacency<E> adjacency(edgeList, comm);
+        return computeDegreeHistogram(adjacency, comm, mode, sampleEdgeTarget);
+      }
+
+    /**
+     * @brief                   Groups the degrees into logarithmic bins
+     * @param[in]  histogram    <degree, frequency> pairs sorted by degree
+     * @param[in]  binRatio     ratio of the upper and lower limits of a bin
+     * @return                  frequency per unit degree of every bin [1, maxDegree]
+     * @details                 Bins are [lo, max(lo+1, lo * binRatio)), so low degrees keep their own bins
+     *                          while the tail is compressed to O(log(maxDegree)) values
+     */
+    inline std::vector<double> logBinnedHistogram(const std::vector<std::pair<std::size_t, double>> &histogram, double binRatio = 1.1)
+    {
+      std::vector<double> binned;
+
+      if(histogram.empty())
+        return binned;
+
+      std::size_t maxDegree = histogram.back().first;
+
+      auto it = histogram.begin();
+
+      for(std::size_t lo = 1; lo <= maxDegree;)
+      {
+        std::size_t hi = std::max(lo + 1, static_cast<std::size_t>(lo * binRatio));
+
+        double binCount = 0;
+        for(; it != histogram.end() && it->first < hi; it++)
+          binCount += it->second;
+
+        //Round to keep the values discrete for plfit
+        binned.push_back(std::round(binCount / (hi - lo)));
+
+        lo = hi;
+      }
+
+      return binned;
+    }
+
+    /**
+     * @brief                   Decides if its optimal to run BFS iteration based on the degree distribution
+     * @param[in]  adjacency    distributed edges, left sorted by (DEST, SRC) if mode = exact
+     * @param[in]  mode         compute the exact degree distribution, or estimate it from a sample
+     * @param[in]  sampleEdgeTarget expected count of edges in the sample (if mode = sampled)
+     * @return                  true if BFS should be executed, false otherwise
+     * @details                 plfit is given the log binned histogram (see logBinnedHistogram()), 
+     *                          i.e. the rounded frequency per unit degree of every bin, plus 1. It used
+     *                          to get the frequency of every degree in [1, maxDegree], plus 1. Degrees 
+     *                          below 20 still have a bin each, the tail is compressed to O(log(maxDegree))
+     *                          values. The 0.05 threshold on the K-S statistic was tuned over the dense 
+     *                          histogram, and is kept as is, it has not been re-tuned for the binned input.
+     * @NOTE                    Assumes each edge is present both ways in the edgeList vector         
+     */
+    template <typename E>
+      bool runBFSDecision(conn::graphGen::sortedAdjacency<E> &adjacency, mxx::comm &comm, 
+          degreeDistMode mode = degreeDistMode::exact, std::size_t sampleEdgeTarget = 1UL << 24)
+      {
+#ifdef BENCHMARK_CONN
+        mxx::section_timer timer(std::cerr, comm);
+#endif
+
+        auto globalDegreeCounts = logBinnedHistogram(computeDegreeHistogram(adjacency, comm, mode, sampleEdgeTarget));
 
         //Add 1 to each element (for stable curve fitting)
         std::for_each(globalDegreeCounts.begin(), globalDegreeCounts.end(), [](double& d) { d+=1.0;});
@@ -194,6 +425,14 @@ namespace conn
         return gbDecision == 1;
       }
 
+    template <typename E>
+      bool runBFSDecision(std::vector<std::pair<E,E>> &edgeList, mxx::comm &comm, 
+          degreeDistMode mode = degreeDistMode::exact, std::size_t sampleEdgeTarget = 1UL << 24)
+      {
+        conn::graphGen::sortedAdjacency<E> adjacency(edgeList, comm);
+        return runBFSDecision(adjacency, comm, mode, sampleEdgeTarget);
+      }
+
   }
 }
  
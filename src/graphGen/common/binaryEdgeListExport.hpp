@@ -30,6 +30,7 @@
 //Includes
 #include <iostream>
 #include <algorithm>
+#include <fstream>
 
 //External includes
 #include "mxx/distribution.hpp"
@@ -54,7 +55,7 @@ namespace conn
         mxx::distribute_inplace(edgeList, comm);
 
         std::string fileName = outputPath + "/" + "graph." + std::to_string(comm.rank()) + ".bin";
-        std::ofstream out(fileName, ios::out | ios::binary);
+        std::ofstream out(fileName, std::ios::out | std::ios::binary);
 
         for(auto &e : edgeList) {
           if(std::get<SRC>(e) < std::get<DEST>(e)) {
@@ -0,0 +1,239 @@
+/*
+ * Copyright 2016 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    edgeRouter.hpp
+ * @ingroup graphGen
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ * @brief   Sends the edges to the owner rank of their source vertex while they are produced
+ *
+ * Copyright (c) 2016 Georgia Institute of Technology. All Rights Reserved.
+ */
+
+#ifndef GRAPH_EDGE_ROUTER_HPP
+#define GRAPH_EDGE_ROUTER_HPP
+
+//Includes
+#include <mpi.h>
+#include <vector>
+#include <list>
+#include <iterator>
+
+//Own includes
+#include "graphGen/common/idDictionary.hpp"
+
+//External includes
+#include "mxx/comm.hpp"
+
+namespace conn
+{
+  namespace graphGen
+  {
+
+    /**
+     * @class     conn::graphGen::edgeRouter
+     * @brief     Buffered point to point routing of edges to the hash owner of the source vertex
+     * @details   Edges are batched per destination rank and sent with MPI_Isend once a batch
+     *            is full, incoming batches are appended to the edge list whenever a batch is sent.
+     *            Edges owned by this rank are appended directly. After finish(), every edge
+     *            (u, v) produced by any rank is on rank vertexToHashOwner(u), same owner
+     *            as used by the id dictionary.
+     *            Every rank of the communicator should call finish() once it is done producing.
+     *            Count of batches in flight is capped, a rank over the cap keeps receiving
+     *            till its sends complete, so a slow receiver holds back the producers instead
+     *            of letting their outbound edges pile up in memory. As a result, no collective
+     *            call should be made on the producers' communicator between the first push()
+     *            and finish(), a rank waiting for its sends would never join it.
+     *            A disabled router appends all the edges locally, so that the producers
+     *            need a single code path.
+     */
+    template <typename E>
+      class edgeRouter
+      {
+        private:
+
+          using edgeType = std::pair<E,E>;
+
+          //Tags of the batches, last batch from a rank tells that it is done
+          static const int TAG_BATCH = 0;
+          static const int TAG_LAST_BATCH = 1;
+
+          //Destination of the routed edges
+          std::vector<edgeType> &edgeList;
+
+          //False if the edges are kept on the producing rank
+          bool enabled;
+
+          //Edges per message
+          std::size_t batchSize;
+
+          //Batches sent but not yet completed, beyond which push() waits
+          std::size_t maxInFlight;
+
+          //Pending edges for every rank
+          std::vector< std::vector<edgeType> > buffers;
+
+          //Batches being sent, kept alive till the send completes
+          std::list< std::pair<MPI_Request, std::vector<edgeType> > > inFlight;
+
+          vertexToHashOwner<E> vertexRankAssigner;
+
+          //Count of ranks that sent their last batch to this rank
+          int ranksDone = 0;
+
+          //Count of edges sent to other ranks
+          std::size_t sentCount = 0;
+
+          //Private communicator, so that the messages do not interfere with the producer
+          //Not duplicated if the router is disabled
+          mxx::comm comm;
+
+        public:
+
+          /**
+           * @brief                 constructor
+           * @param[in] edgeList    routed edges are appended to this vector
+           * @param[in] comm        mpi communicator
+           * @param[in] enabled     route the edges, or keep them on the producing rank
+           * @param[in] batchSize   edges per message
+           * @param[in] maxInFlight batches in flight, bounds the memory held by the sends
+           */
+          edgeRouter(std::vector<edgeType> &_edgeList, const mxx::comm &_comm, bool _enabled = true, 
+              std::size_t _batchSize = 1UL << 14, std::size_t _maxInFlight = 64)
+            : edgeList(_edgeList), enabled(_enabled), batchSize(_batchSize), maxInFlight(_maxInFlight), 
+            buffers(_enabled ? _comm.size() : 0), vertexRankAssigner(_comm.size()), 
+            comm(_enabled ? _comm.copy() : mxx::comm(static_cast<MPI_Comm>(_comm)))
+          {
+          }
+
+          /**
+           * @brief     route the edge (u, v) to the owner of u
+           */
+          void push(const E &u, const E &v)
+          {
+            int owner = enabled ? vertexRankAssigner(u) : comm.rank();
+
+            if(owner == comm.rank())
+            {
+              edgeList.emplace_back(u, v);
+              return;
+            }
+
+            buffers[owner].emplace_back(u, v);
+
+            if(buffers[owner].size() >= batchSize)
+            {
+              send(owner, TAG_BATCH);
+              poll();
+
+              //Wait for the receivers to catch up, still receiving their batches
+              while(inFlight.size() >= maxInFlight)
+                poll();
+            }
+          }
+
+          /**
+           * @brief     send the remaining edges, and receive till all the ranks are done
+           * @return    count of edges sent to other ranks by this rank
+           */
+          std::size_t finish()
+          {
+            if(!enabled)
+              return 0;
+
+            for(int r = 0; r < comm.size(); r++)
+              if(r != comm.rank())
+                send(r, TAG_LAST_BATCH);
+
+            while(ranksDone < comm.size() - 1)
+            {
+              MPI_Status status;
+              MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, comm, &status);
+              receive(status);
+            }
+
+            for(auto &b : inFlight)
+              MPI_Wait(&b.first, MPI_STATUS_IGNORE);
+
+            inFlight.clear();
+
+            return sentCount;
+          }
+
+        private:
+
+          /**
+           * @brief     sends the buffer of a rank, buffer is left empty
+           */
+          void send(int rank, int tag)
+          {
+            inFlight.emplace_back(MPI_REQUEST_NULL, std::vector<edgeType>());
+
+            auto &batch = inFlight.back();
+            batch.second.swap(buffers[rank]);
+
+            MPI_Isend(batch.second.data(), batch.second.size() * sizeof(edgeType), MPI_BYTE, rank, tag, comm, &batch.first);
+
+            sentCount += batch.second.size();
+          }
+
+          /**
+           * @brief     receives the available batches, and releases the completed sends
+           */
+          void poll()
+          {
+            int available = 1;
+
+            while(available)
+            {
+              MPI_Status status;
+              MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, comm, &available, &status);
+
+              if(available)
+                receive(status);
+            }
+
+            for(auto it = inFlight.begin(); it != inFlight.end();)
+            {
+              int completed;
+              MPI_Test(&it->first, &completed, MPI_STATUS_IGNORE);
+
+              it = completed ? inFlight.erase(it) : std::next(it);
+            }
+          }
+
+          /**
+           * @brief     receives the probed batch into the edge list
+           */
+          void receive(const MPI_Status &status)
+          {
+            int countBytes;
+            MPI_Get_count(&status, MPI_BYTE, &countBytes);
+
+            std::size_t initialSize = edgeList.size();
+            edgeList.resize(initialSize + countBytes / sizeof(edgeType));
+
+            MPI_Recv(edgeList.data() + initialSize, countBytes, MPI_BYTE, status.MPI_SOURCE, status.MPI_TAG, comm, MPI_STATUS_IGNORE);
+
+            if(status.MPI_TAG == TAG_LAST_BATCH)
+              ranksDone++;
+          }
+      };
+
+  }
+}
+
+#endif
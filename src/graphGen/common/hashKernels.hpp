@@ -0,0 +1,285 @@
+/*
+ * Copyright 2016 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    hashKernels.hpp
+ * @ingroup graphGen
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ * @brief   Vectorized and multithreaded versions of hash_64() and hash_64i()
+ *          over arrays of 64-bit keys
+ * @details AVX-512 or AVX2 kernels are chosen at compile time (e.g. -march=native),
+ *          with a scalar fallback. Arrays are split across OpenMP threads if enabled.
+ *          Results are bit-identical to hash_64<uint64_t>() and hash_64i<uint64_t>()
+ *
+ * Copyright (c) 2016 Georgia Institute of Technology. All Rights Reserved.
+ */
+
+#ifndef GRAPH_HASH_KERNELS_HPP
+#define GRAPH_HASH_KERNELS_HPP
+
+//Includes
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+//External includes
+#include "hash/invertible_hash.hpp"
+
+namespace conn
+{
+  namespace graphGen
+  {
+    namespace hashLanes
+    {
+      /**
+       * @brief   64-bit lane operations used by the hash functions, one struct per instruction set
+       */
+      struct scalarOps
+      {
+        using type = uint64_t;
+        static const std::size_t width = 1;
+
+        static type load(const uint64_t *p) { return *p; }
+        static void store(uint64_t *p, type a) { *p = a; }
+        static type add(type a, type b) { return a + b; }
+        static type sub(type a, type b) { return a - b; }
+        static type bitXor(type a, type b) { return a ^ b; }
+        static type bitNot(type a) { return ~a; }
+        template <int n> static type shl(type a) { return a << n; }
+        template <int n> static type shr(type a) { return a >> n; }
+        static type mul(type a, uint64_t c) { return a * c; }
+      };
+
+#if defined(__AVX2__)
+      struct avx2Ops
+      {
+        using type = __m256i;
+        static const std::size_t width = 4;
+
+        static type load(const uint64_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        static void store(uint64_t *p, type a) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), a); }
+        static type add(type a, type b) { return _mm256_add_epi64(a, b); }
+        static type sub(type a, type b) { return _mm256_sub_epi64(a, b); }
+        static type bitXor(type a, type b) { return _mm256_xor_si256(a, b); }
+        static type bitNot(type a) { return _mm256_xor_si256(a, _mm256_set1_epi64x(-1)); }
+        template <int n> static type shl(type a) { return _mm256_slli_epi64(a, n); }
+        template <int n> static type shr(type a) { return _mm256_srli_epi64(a, n); }
+
+        //No 64-bit multiply in AVX2, composed from 32x32->64 products
+        static type mul(type a, uint64_t c)
+        {
+          type cLo = _mm256_set1_epi64x(static_cast<int64_t>(c & 0xFFFFFFFFULL));
+          type cHi = _mm256_set1_epi64x(static_cast<int64_t>(c >> 32));
+
+          type loLo = _mm256_mul_epu32(a, cLo);
+          type hiLo = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), cLo);
+          type loHi = _mm256_mul_epu32(a, cHi);
+
+          return _mm256_add_epi64(loLo, _mm256_slli_epi64(_mm256_add_epi64(hiLo, loHi), 32));
+        }
+      };
+#endif
+
+#if defined(__AVX512F__)
+      struct avx512Ops
+      {
+        using type = __m512i;
+        static const std::size_t width = 8;
+
+        static type load(const uint64_t *p) { return _mm512_loadu_si512(p); }
+        static void store(uint64_t *p, type a) { _mm512_storeu_si512(p, a); }
+        static type add(type a, type b) { return _mm512_add_epi64(a, b); }
+        static type sub(type a, type b) { return _mm512_sub_epi64(a, b); }
+        static type bitXor(type a, type b) { return _mm512_xor_si512(a, b); }
+        static type bitNot(type a) { return _mm512_xor_si512(a, _mm512_set1_epi64(-1)); }
+        template <int n> static type shl(type a) { return _mm512_slli_epi64(a, n); }
+        template <int n> static type shr(type a) { return _mm512_srli_epi64(a, n); }
+
+        static type mul(type a, uint64_t c)
+        {
+#if defined(__AVX512DQ__)
+          return _mm512_mullo_epi64(a, _mm512_set1_epi64(static_cast<int64_t>(c)));
+#else
+          type cLo = _mm512_set1_epi64(static_cast<int64_t>(c & 0xFFFFFFFFULL));
+          type cHi = _mm512_set1_epi64(static_cast<int64_t>(c >> 32));
+
+          type loLo = _mm512_mul_epu32(a, cLo);
+          type hiLo = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), cLo);
+          type loHi = _mm512_mul_epu32(a, cHi);
+
+          return _mm512_add_epi64(loLo, _mm512_slli_epi64(_mm512_add_epi64(hiLo, loHi), 32));
+#endif
+        }
+      };
+#endif
+
+      //Widest instruction set available at compile time
+#if defined(__AVX512F__)
+      using nativeOps = avx512Ops;
+#elif defined(__AVX2__)
+      using nativeOps = avx2Ops;
+#else
+      using nativeOps = scalarOps;
+#endif
+
+      /**
+       * @brief   same steps as hash_64()
+       */
+      template <typename V>
+        inline typename V::type hash64(typename V::type key)
+        {
+          key = V::add(V::bitNot(key), V::template shl<21>(key));
+          key = V::bitXor(key, V::template shr<24>(key));
+          key = V::add(V::add(key, V::template shl<3>(key)), V::template shl<8>(key));
+          key = V::bitXor(key, V::template shr<14>(key));
+          key = V::add(V::add(key, V::template shl<2>(key)), V::template shl<4>(key));
+          key = V::bitXor(key, V::template shr<28>(key));
+          key = V::add(key, V::template shl<31>(key));
+          return key;
+        }
+
+      /**
+       * @brief   same steps as hash_64i()
+       */
+      template <typename V>
+        inline typename V::type hash64i(typename V::type key)
+        {
+          typename V::type tmp;
+
+          tmp = V::sub(key, V::template shl<31>(key));
+          key = V::sub(key, V::template shl<31>(tmp));
+
+          tmp = V::bitXor(key, V::template shr<28>(key));
+          key = V::bitXor(key, V::template shr<28>(tmp));
+
+          key = V::mul(key, 14933078535860113213ull);
+
+          tmp = V::bitXor(key, V::template shr<14>(key));
+          tmp = V::bitXor(key, V::template shr<14>(tmp));
+          tmp = V::bitXor(key, V::template shr<14>(tmp));
+          key = V::bitXor(key, V::template shr<14>(tmp));
+
+          key = V::mul(key, 15244667743933553977ull);
+
+          tmp = V::bitXor(key, V::template shr<24>(key));
+          key = V::bitXor(key, V::template shr<24>(tmp));
+
+          tmp = V::bitNot(key);
+          tmp = V::bitNot(V::sub(key, V::template shl<21>(tmp)));
+          tmp = V::bitNot(V::sub(key, V::template shl<21>(tmp)));
+          key = V::bitNot(V::sub(key, V::template shl<21>(tmp)));
+          return key;
+        }
+
+      struct forward
+      {
+        template <typename V>
+          static typename V::type apply(typename V::type key) { return hash64<V>(key); }
+      };
+
+      struct inverse
+      {
+        template <typename V>
+          static typename V::type apply(typename V::type key) { return hash64i<V>(key); }
+      };
+
+      /**
+       * @brief   applies the hash over a contiguous range, full vectors first and the
+       *          remaining keys with scalar code
+       */
+      template <typename V, typename F>
+        inline void applyRange(uint64_t *keys, std::size_t n)
+        {
+          std::size_t i = 0;
+
+          for(; i + V::width <= n; i += V::width)
+            V::store(keys + i, F::template apply<V>(V::load(keys + i)));
+
+          for(; i < n; i++)
+            keys[i] = F::template apply<scalarOps>(keys[i]);
+        }
+
+      /**
+       * @brief   splits the array into blocks across the threads
+       */
+      template <typename F>
+        inline void applyParallel(uint64_t *keys, std::size_t n)
+        {
+          //Keys per block, large enough to amortize the scheduling
+          const std::size_t blockSize = 1UL << 16;
+
+          const std::ptrdiff_t blockCount = (n + blockSize - 1) / blockSize;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(blockCount > 1)
+#endif
+          for(std::ptrdiff_t b = 0; b < blockCount; b++)
+          {
+            std::size_t begin = b * blockSize;
+            std::size_t end = std::min(n, begin + blockSize);
+
+            applyRange<nativeOps, F>(keys + begin, end - begin);
+          }
+        }
+    }
+
+    /*
+     * @brief   permutes a vertex id using invertible hash function
+     * @note    hash is computed over unsigned bits, arithmetic shifts of 
+     *          signed types would make it non-invertible
+     */
+    template <typename E>
+      E permuteId(E id)
+      {
+        uint64_t key = static_cast<uint64_t>(id);
+        hash_64(key);
+        return static_cast<E>(key);
+      }
+
+    /*
+     * @brief   original vertex id of an id permuted by permuteId()
+     */
+    template <typename E>
+      E invertPermutedId(E id)
+      {
+        uint64_t key = static_cast<uint64_t>(id);
+        hash_64i(key);
+        return static_cast<E>(key);
+      }
+
+    /**
+     * @brief             hash_64() over an array of keys, in place
+     */
+    inline void hash_64_batch(uint64_t *keys, std::size_t n)
+    {
+      hashLanes::applyParallel<hashLanes::forward>(keys, n);
+    }
+
+    /**
+     * @brief             hash_64i() over an array of keys, in place
+     */
+    inline void hash_64i_batch(uint64_t *keys, std::size_t n)
+    {
+      hashLanes::applyParallel<hashLanes::inverse>(keys, n);
+    }
+  }
+}
+
+#endif
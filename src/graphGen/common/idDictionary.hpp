@@ -0,0 +1,272 @@
+/*
+ * Copyright 2016 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    idDictionary.hpp
+ * @ingroup graphGen
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ * @brief   Distributed dictionary that maps sparse vertex ids to contiguous ids,
+ *          built using hash based routing instead of sorting the edge list
+ *
+ * Copyright (c) 2016 Georgia Institute of Technology. All Rights Reserved.
+ */
+
+#ifndef GRAPH_ID_DICTIONARY_HPP
+#define GRAPH_ID_DICTIONARY_HPP
+
+//Includes
+#include <mpi.h>
+#include <iostream>
+#include <algorithm>
+#include <limits>
+#include <cassert>
+
+//Own includes
+#include "graphGen/common/hashKernels.hpp"
+
+//External includes
+#include "mxx/comm.hpp"
+#include "mxx/collective.hpp"
+#include "mxx/reduction.hpp"
+#include "mxx/algos.hpp"
+
+namespace conn
+{
+  namespace graphGen
+  {
+
+    /**
+     * @brief             Functor to assign owner rank for a given vertex id by hashing it
+     */
+    template <typename E>
+      struct vertexToHashOwner
+      {
+        int p;
+
+        //Constructor
+        vertexToHashOwner(int p) : p(p) {
+        }
+
+        int operator() (const E& valueToBucket) const
+        {
+          uint64_t key = static_cast<uint64_t>(valueToBucket);
+          hash_64(key);
+
+          return key % p;
+        }
+      };
+
+    /**
+     * @class                     conn::graphGen::idDictionary
+     * @brief                     distributed dictionary which maps sparse vertex ids to contiguous ids [0, |V|)
+     * @details                   Each unique vertex id is owned by the rank chosen by hashing the id.
+     *                            Owners sort their ids locally and number them after an exscan of the
+     *                            unique counts. Every rank learns the contiguous ids of the vertices that
+     *                            appear in its own edges through a single request/response all2all.
+     *                            Only vertex ids are communicated, the edge list is neither moved nor sorted.
+     */
+    template <typename E>
+      class idDictionary
+      {
+        private:
+
+          //Ids owned by this rank, sorted
+          //Contiguous id of ownedIds[i] is ownedOffset + i
+          std::vector<E> ownedIds;
+
+          //Contiguous id of the first vertex owned by this rank
+          E ownedOffset;
+
+          //Total count of unique vertices
+          std::size_t globalCount;
+
+          //<id, contiguous id> of the vertices referenced by the local edges, sorted by id
+          std::vector< std::pair<E,E> > localLookup;
+
+          //MPI communicator
+          mxx::comm comm;
+
+        public:
+
+          /**
+           * @brief                 constructor, builds the dictionary
+           * @param[in] edgeList    distributed edge list over sparse vertex ids
+           * @param[in] comm        mpi communicator
+           */
+          idDictionary(const std::vector< std::pair<E,E> > &edgeList, const mxx::comm &_comm) : comm(_comm.copy())
+          {
+            build(edgeList);
+          }
+
+          /**
+           * @brief     count of unique vertices in the graph
+           */
+          std::size_t size() const
+          {
+            return globalCount;
+          }
+
+          /**
+           * @brief     contiguous id of a vertex
+           * @note      the vertex should be present in the local edges used to build the dictionary
+           */
+          E lookup(const E &id) const
+          {
+            auto it = std::lower_bound(localLookup.begin(), localLookup.end(), std::make_pair(id, std::numeric_limits<E>::min()));
+
+            assert(it != localLookup.end() && it->first == id);
+
+            return it->second;
+          }
+
+          /**
+           * @brief     <id, contiguous id> pairs of the vertices in the local edges, sorted by id
+           */
+          const std::vector< std::pair<E,E> >& getLocalLookup() const
+          {
+            return localLookup;
+          }
+
+          /**
+           * @brief     sorted ids owned by this rank, contiguous id of ownedIds[i] is getOwnedOffset() + i
+           */
+          const std::vector<E>& getOwnedIds() const
+          {
+            return ownedIds;
+          }
+
+          E getOwnedOffset() const
+          {
+            return ownedOffset;
+          }
+
+          /**
+           * @brief                 rebuild the local lookup table for the edges this rank now holds,
+           *                        e.g. after the edges were moved across ranks
+           * @details               Same request/response all2all as the construction, the owned
+           *                        ids and their contiguous ids are unchanged
+           * @param[in] edgeList    distributed edge list, subset of the edges used to build the dictionary
+           */
+          void updateLocalLookup(const std::vector< std::pair<E,E> > &edgeList)
+          {
+            std::vector<E> requests = uniqueIds(edgeList);
+
+            vertexToHashOwner<E> vertexRankAssigner(comm.size());
+            std::vector<std::size_t> sendCounts = mxx::bucketing(requests, vertexRankAssigner, comm.size());
+            std::vector<std::size_t> recvCounts = mxx::all2all(sendCounts, comm);
+
+            std::vector<E> received = mxx::all2allv(requests, sendCounts, comm);
+
+            answerRequests(requests, received, recvCounts);
+          }
+
+          /**
+           * @brief                 replace the vertex ids of the edges with the contiguous ids
+           * @param[in] edgeList    edges, should be the same as or a subset of the local edges
+           *                        used to build the dictionary, or given to updateLocalLookup()
+           */
+          void relabel(std::vector< std::pair<E,E> > &edgeList) const
+          {
+            const int SRC = 0, DEST = 1;
+
+            for(auto &e : edgeList)
+            {
+              std::get<SRC>(e) = lookup(std::get<SRC>(e));
+              std::get<DEST>(e) = lookup(std::get<DEST>(e));
+            }
+          }
+
+        private:
+
+          /**
+           * @brief     route the unique local ids to their owners, number them
+           *            and send the contiguous ids back
+           */
+          void build(const std::vector< std::pair<E,E> > &edgeList)
+          {
+            std::vector<E> requests = uniqueIds(edgeList);
+
+            //Bucket the ids by their owners
+            vertexToHashOwner<E> vertexRankAssigner(comm.size());
+            std::vector<std::size_t> sendCounts = mxx::bucketing(requests, vertexRankAssigner, comm.size());
+            std::vector<std::size_t> recvCounts = mxx::all2all(sendCounts, comm);
+
+            std::vector<E> received = mxx::all2allv(requests, sendCounts, comm);
+
+            //Ids owned by this rank
+            ownedIds = received;
+            std::sort(ownedIds.begin(), ownedIds.end());
+            ownedIds.erase(std::unique(ownedIds.begin(), ownedIds.end()), ownedIds.end());
+
+            //Number the owned ids
+            E localCount = ownedIds.size();
+            ownedOffset = mxx::exscan(localCount, std::plus<E>(), comm);
+            if(!comm.rank()) ownedOffset = 0;
+
+            globalCount = mxx::allreduce(localCount, std::plus<E>(), comm);
+
+            answerRequests(requests, received, recvCounts);
+          }
+
+          /**
+           * @brief     unique vertex ids referenced by the edges, sorted
+           */
+          static std::vector<E> uniqueIds(const std::vector< std::pair<E,E> > &edgeList)
+          {
+            const int SRC = 0, DEST = 1;
+
+            std::vector<E> ids;
+            ids.reserve(2 * edgeList.size());
+
+            for(auto &e : edgeList)
+            {
+              ids.push_back(std::get<SRC>(e));
+              ids.push_back(std::get<DEST>(e));
+            }
+
+            std::sort(ids.begin(), ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+            return ids;
+          }
+
+          /**
+           * @brief     send the contiguous ids of the received (owned) ids back, 
+           *            and fill the local lookup table with the responses
+           * @param[in] requests    ids asked by this rank, bucketed by their owners
+           * @param[in] received    ids asked to this rank, in the order they were received
+           */
+          void answerRequests(const std::vector<E> &requests, std::vector<E> &received, const std::vector<std::size_t> &recvCounts)
+          {
+            //Answer the requests in the order they were received
+            for(auto &v : received)
+              v = ownedOffset + std::distance(ownedIds.begin(), std::lower_bound(ownedIds.begin(), ownedIds.end(), v));
+
+            std::vector<E> responses = mxx::all2allv(received, recvCounts, comm);
+
+            //Responses are aligned with the bucketed requests
+            localLookup.resize(requests.size());
+            for(std::size_t i = 0; i < requests.size(); i++)
+              localLookup[i] = std::make_pair(requests[i], responses[i]);
+
+            std::sort(localLookup.begin(), localLookup.end());
+          }
+      };
+
+  }
+}
+
+#endif
@@ -0,0 +1,271 @@
+/*
+ * Copyright 2016 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    idMapping.hpp
+ * @ingroup graphGen
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ * @brief   Block distributed table of the original ids of contiguous vertex ids,
+ *          used to report the component labels in terms of the input vertex ids
+ *
+ * Copyright (c) 2016 Georgia Institute of Technology. All Rights Reserved.
+ */
+
+#ifndef GRAPH_ID_MAPPING_HPP
+#define GRAPH_ID_MAPPING_HPP
+
+//Includes
+#include <mpi.h>
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+#include <string>
+
+//Own includes
+#include "graphGen/common/reduceIds.hpp"
+
+//External includes
+#include "mxx/comm.hpp"
+#include "mxx/collective.hpp"
+#include "mxx/reduction.hpp"
+#include "mxx/algos.hpp"
+
+namespace conn
+{
+  namespace graphGen
+  {
+
+    /**
+     * @class                     conn::graphGen::idMapping
+     * @brief                     maps contiguous vertex ids back to the ids they replaced
+     * @details                   Rank i holds the old ids of the new ids [offset_i, offset_i + n_i).
+     *                            On disk, the table is a single flat array of E indexed by the new id,
+     *                            so it can be memory mapped by sequential tools, or read back by any
+     *                            count of ranks.
+     */
+    template <typename E>
+      class idMapping
+      {
+        private:
+
+          //Largest single read or write, MPI counts are int
+          static const std::size_t MAX_IO = 1UL << 30;
+
+          //Old ids of the new ids [offset, offset + oldIds.size())
+          std::vector<E> oldIds;
+
+          //First new id held by this rank
+          E offset;
+
+          //First new id held by every rank
+          std::vector<E> allOffsets;
+
+          //MPI communicator
+          mxx::comm comm;
+
+        public:
+
+          /**
+           * @brief                       constructor
+           * @param[in] uniqueVertexList  distributed array of original vertex ids (global index of vertex here
+           *                              is its new id), e.g. from reduceVertexIds()
+           */
+          idMapping(std::vector<E> uniqueVertexList, const mxx::comm &_comm) : oldIds(std::move(uniqueVertexList)), comm(_comm.copy())
+          {
+            computeOffsets();
+          }
+
+          /**
+           * @brief     count of vertices in the table
+           */
+          std::size_t size() const
+          {
+            return mxx::allreduce(oldIds.size(), comm);
+          }
+
+          /**
+           * @brief                 write the table to a file, using MPI-IO
+           */
+          void write(const std::string &fileName) const
+          {
+            MPI_File fh;
+            MPI_File_open(comm, const_cast<char*>(fileName.c_str()), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh);
+            MPI_File_set_size(fh, 0);
+
+            char *buffer = reinterpret_cast<char*>(const_cast<E*>(oldIds.data()));
+            std::size_t length = oldIds.size() * sizeof(E);
+            MPI_Offset fileOffset = static_cast<MPI_Offset>(offset) * sizeof(E);
+
+            //Collective calls are matched across the ranks, ranks with less data write empty chunks
+            std::size_t rounds = ioRounds(length, comm);
+
+            for(std::size_t r = 0, done = 0; r < rounds; r++)
+            {
+              std::size_t chunk = length - done < MAX_IO ? length - done : MAX_IO;
+
+              MPI_File_write_at_all(fh, fileOffset + static_cast<MPI_Offset>(done), buffer + done,
+                  static_cast<int>(chunk), MPI_BYTE, MPI_STATUS_IGNORE);
+
+              done += chunk;
+            }
+
+            MPI_File_close(&fh);
+          }
+
+          /**
+           * @brief                 read a table written by write(), block distributed across the ranks
+           */
+          static idMapping<E> read(const std::string &fileName, const mxx::comm &comm)
+          {
+            MPI_File fh;
+            MPI_File_open(comm, const_cast<char*>(fileName.c_str()), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh);
+
+            MPI_Offset fileSize;
+            MPI_File_get_size(fh, &fileSize);
+
+            std::size_t count = fileSize / sizeof(E);
+
+            //Even split, first (count % p) ranks get one extra element
+            std::size_t localCount = count / comm.size() + (comm.rank() < count % comm.size() ? 1 : 0);
+            std::size_t localOffset = comm.rank() * (count / comm.size()) + std::min<std::size_t>(comm.rank(), count % comm.size());
+
+            std::vector<E> table(localCount);
+
+            char *buffer = reinterpret_cast<char*>(table.data());
+            std::size_t length = localCount * sizeof(E);
+            MPI_Offset fileOffset = static_cast<MPI_Offset>(localOffset) * sizeof(E);
+
+            std::size_t rounds = ioRounds(length, comm);
+
+            for(std::size_t r = 0, done = 0; r < rounds; r++)
+            {
+              std::size_t chunk = length - done < MAX_IO ? length - done : MAX_IO;
+
+              MPI_File_read_at_all(fh, fileOffset + static_cast<MPI_Offset>(done), buffer + done,
+                  static_cast<int>(chunk), MPI_BYTE, MPI_STATUS_IGNORE);
+
+              done += chunk;
+            }
+
+            MPI_File_close(&fh);
+
+            return idMapping<E>(std::move(table), comm);
+          }
+
+          /**
+           * @brief                 old ids of the given new ids
+           * @param[in] newIds      contiguous ids, may repeat
+           * @return                old ids, in the same order as newIds
+           * @details               Requests are routed to the ranks holding the ids, and answered
+           *                        through a single request/response all2all. Nothing is sorted.
+           */
+          std::vector<E> lookup(const std::vector<E> &newIds) const
+          {
+            //<new id, index in newIds>
+            std::vector< std::pair<E, std::size_t> > queries(newIds.size());
+            for(std::size_t i = 0; i < newIds.size(); i++)
+              queries[i] = std::make_pair(newIds[i], i);
+
+            std::vector<std::size_t> sendCounts = mxx::bucketing(queries, [&](const std::pair<E, std::size_t> &q){
+                return std::distance(allOffsets.begin(), std::upper_bound(allOffsets.begin(), allOffsets.end(), q.first)) - 1;
+                }, comm.size());
+
+            std::vector<std::size_t> recvCounts = mxx::all2all(sendCounts, comm);
+
+            std::vector<E> queryIds(queries.size());
+            std::transform(queries.begin(), queries.end(), queryIds.begin(), [](const std::pair<E, std::size_t> &q){ return q.first; });
+
+            auto receivedIds = mxx::all2allv(queryIds, sendCounts, comm);
+
+            for(auto &v : receivedIds)
+            {
+              assert(v >= offset && v - offset < oldIds.size());
+              v = oldIds[v - offset];
+            }
+
+            auto responses = mxx::all2allv(receivedIds, recvCounts, comm);
+
+            std::vector<E> result(newIds.size());
+            for(std::size_t i = 0; i < queries.size(); i++)
+              result[queries[i].second] = responses[i];
+
+            return result;
+          }
+
+        private:
+
+          /**
+           * @brief                 count of collective calls needed to move the largest local part
+           */
+          static std::size_t ioRounds(std::size_t length, const mxx::comm &comm)
+          {
+            std::size_t localRounds = (length + MAX_IO - 1) / MAX_IO;
+            return mxx::allreduce(localRounds, mxx::max<std::size_t>(), comm);
+          }
+
+          void computeOffsets()
+          {
+            E localCount = oldIds.size();
+            offset = mxx::exscan(localCount, std::plus<E>(), comm);
+            if(!comm.rank()) offset = 0;
+
+            allOffsets = mxx::allgather(offset, comm);
+          }
+      };
+
+    /**
+     * @brief                   translates the component labels back to the original vertex ids
+     * @param[in,out] labels    distributed <vertex, component label> pairs, both are vertex ids as seen by ccl
+     * @param[in] mapping       table of the contiguous ids, null if the ids were not made contiguous
+     * @param[in] permuted      true if the ids were permuted using permuteVectorIds()
+     * @details                 Both the vertex and its label (a vertex of the same component) are translated,
+     *                          first through the mapping and then through the inverse hash
+     */
+    template <typename E>
+      void translateLabels(std::vector< std::pair<E,E> > &labels, const idMapping<E> *mapping, bool permuted)
+      {
+        const int VERTEX = 0, LABEL = 1;
+
+        if(mapping)
+        {
+          std::vector<E> ids(2 * labels.size());
+          for(std::size_t i = 0; i < labels.size(); i++)
+          {
+            ids[2*i] = std::get<VERTEX>(labels[i]);
+            ids[2*i + 1] = std::get<LABEL>(labels[i]);
+          }
+
+          ids = mapping->lookup(ids);
+
+          for(std::size_t i = 0; i < labels.size(); i++)
+          {
+            std::get<VERTEX>(labels[i]) = ids[2*i];
+            std::get<LABEL>(labels[i]) = ids[2*i + 1];
+          }
+        }
+
+        if(permuted)
+        {
+          static_assert(sizeof(std::pair<E,E>) == 2 * sizeof(uint64_t), "Vertex ids should be 64-bit");
+
+          hash_64i_batch(reinterpret_cast<uint64_t*>(labels.data()), 2 * labels.size());
+        }
+      }
+
+  }
+}
+
+#endif
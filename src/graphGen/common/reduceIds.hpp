@@ -35,6 +35,8 @@
 //Own includes
 #include "utils/commonfuncs.hpp"
 #include "graphGen/common/utils.hpp"
+#include "graphGen/common/sortedAdjacency.hpp"
+#include "graphGen/common/idDictionary.hpp"
 
 //External includes
 #include "mxx/distribution.hpp"
@@ -42,7 +44,7 @@
 #include "mxx/sort.hpp"
 #include "mxx/algos.hpp"
 #include "mxx/utils.hpp"
-#include "hash/invertible_hash.hpp"
+#include "graphGen/common/hashKernels.hpp"
 
 namespace conn 
 {
@@ -104,130 +106,166 @@ namespace conn
     template <typename E>
       void permuteVectorIds(std::vector<std::pair<E,E>> &edgeList)
       {
-        const int SRC = 0, DEST = 1;
+        static_assert(sizeof(std::pair<E,E>) == 2 * sizeof(uint64_t), "Vertex ids should be 64-bit");
 
-        for(auto &e : edgeList)
-        {
-          hash_64(std::get<SRC>(e));
-          hash_64(std::get<DEST>(e));
-        }
+        //Both endpoints of all the edges are contiguous 64-bit keys
+        hash_64_batch(reinterpret_cast<uint64_t*>(edgeList.data()), 2 * edgeList.size());
       }
 
     /**
-     * @brief                         Given a graph as list of edges, it updates all the vertex ids so
-     *                                that they are contiguos from 0 to |V-1|
-     * @param[in]  edgeList           distributed vector of edges
-     * @param[out] uniqueVertexList   distributed array of original vertex ids (global index of vertex here is its new id)
-     * @details                       (u, v) edge in the edgeList is transfromed to (x, y) if u is the xth 
-     *                                element in the sorted order of all unique vertices, lly for v is yth 
-     *                                Implemented using bucketing and all2all communication
+     * @brief                         Replaces the ids of a single layer with their rank among the unique ids
+     * @param[in]  adjacency          distributed edges, sorted here by the layer unless already sorted by it
+     * @param[out] uniqueVertexCount  count of unique ids in the layer
+     * @details                       Relabeling is monotone, so the sort order of the edges is preserved
      */
-    template <typename E>
-      void reduceVertexIds(std::vector<std::pair<E,E>> &edgeList, std::size_t &uniqueVertexCount, const mxx::comm &comm)
+    template <int layer, typename E>
+      void relabelLayerContiguous(sortedAdjacency<E> &adjacency, std::size_t &uniqueVertexCount)
       {
-        const int SRC = 0, DEST = 1;
-
-        //Ensure the block decomposition of edgeList
-        mxx::distribute_inplace(edgeList, comm);
-
-        //Update the DEST layer of all the edges
-        {
-          //Globally sort all the edges by DEST layer
-          if(!mxx::is_sorted(edgeList.begin(), edgeList.end(), conn::utils::TpleComp<DEST>(), comm))
-            mxx::sort(edgeList.begin(), edgeList.end(), conn::utils::TpleComp<DEST>(), comm);
+        const mxx::comm &comm = adjacency.getComm();
 
-          E localVertexIndex = 0;
+        //Globally sort all the edges by this layer
+        adjacency.template sortBy<layer>();
 
-          //my last vertex id
-          E lastLocalVertexId = std::get<DEST>(edgeList.back());
+        auto &edgeList = adjacency.edges();
 
-          //my first vertex id
-          E firstLocalVertexId = std::get<DEST>(edgeList.front());
+        //my last vertex id
+        E lastLocalVertexId = std::get<layer>(edgeList.back());
 
-          //Start traversal over vertex array
-          for(auto it = edgeList.begin(); it != edgeList.end();)
-          {
-            //Edges whose dest element are equal
-            auto edgeListRange = conn::utils::findRange(it, edgeList.end(), *it, conn::utils::TpleComp<DEST>()); 
-
-            /*
-             * TODO
-             * Preserve these mappings in a separate container if 
-             * we wish to revert the vertex ids back
-             */
-
-            std::for_each(edgeListRange.first, edgeListRange.second, [&](std::pair<E,E> &e){
-                std::get<DEST>(e) = localVertexIndex;
-                });
-
-            //Adavance the loop variables
-            it = edgeListRange.second;
-            localVertexIndex++;
-          }
+        //my first vertex id
+        E firstLocalVertexId = std::get<layer>(edgeList.front());
 
-          E localUniqueVertexCount = localVertexIndex;
+        //Each run of equal ids is a vertex
+        const auto &runOffsets = adjacency.getRunOffsets();
 
-          //Need to compute prefix count of non-shared vertex buckets
-          E exScanUniqueVertices = 0;
+        for(std::size_t r = 0; r + 1 < runOffsets.size(); r++)
+        {
+          /*
+           * TODO
+           * Preserve these mappings in a separate container if 
+           * we wish to revert the vertex ids back
+           */
+
+          std::for_each(edgeList.begin() + runOffsets[r], edgeList.begin() + runOffsets[r+1], [&](std::pair<E,E> &e){
+              std::get<layer>(e) = r;
+              });
+        }
 
-          E nextProcsFirstVertexId = mxx::left_shift(firstLocalVertexId, comm);
-          if(comm.rank() != (comm.size() - 1) && lastLocalVertexId == nextProcsFirstVertexId)
-            localUniqueVertexCount--; //Deduct the extra bucket this rank counted
+        E localUniqueVertexCount = runOffsets.size() - 1;
 
-          exScanUniqueVertices = mxx::exscan(localUniqueVertexCount, std::plus<E>(), comm);
-          uniqueVertexCount = mxx::allreduce(localUniqueVertexCount, std::plus<E>(), comm);
+        //Need to compute prefix count of non-shared vertex buckets
+        E exScanUniqueVertices = 0;
 
-          if(!comm.rank()) exScanUniqueVertices = 0;
+        E nextProcsFirstVertexId = mxx::left_shift(firstLocalVertexId, comm);
+        if(comm.rank() != (comm.size() - 1) && lastLocalVertexId == nextProcsFirstVertexId)
+          localUniqueVertexCount--; //Deduct the extra bucket this rank counted
 
-          //Revise all the vertex ids to global index
-          std::for_each(edgeList.begin(), edgeList.end(), [&](std::pair<E,E> &e){
-              std::get<DEST>(e) += exScanUniqueVertices;
-              });
-        } //DEST layer updated
+        exScanUniqueVertices = mxx::exscan(localUniqueVertexCount, std::plus<E>(), comm);
+        uniqueVertexCount = mxx::allreduce(localUniqueVertexCount, std::plus<E>(), comm);
 
-        //Update the SRC layer of all the edges
-        {
-          mxx::sort(edgeList.begin(), edgeList.end(), conn::utils::TpleComp<SRC>(), comm);
+        if(!comm.rank()) exScanUniqueVertices = 0;
 
-          E localVertexIndex = 0;
+        //Revise all the vertex ids to global index
+        std::for_each(edgeList.begin(), edgeList.end(), [&](std::pair<E,E> &e){
+            std::get<layer>(e) += exScanUniqueVertices;
+            });
+      }
 
-          //my last vertex id
-          E lastLocalVertexId = std::get<SRC>(edgeList.back());
+    /**
+     * @brief                         Given a graph as list of edges, it updates all the vertex ids so
+     *                                that they are contiguos from 0 to |V-1|
+     * @param[in]  adjacency          distributed edges, their current sort order is reused
+     * @param[out] uniqueVertexCount  count of unique vertices
+     * @details                       (u, v) edge in the edgeList is transfromed to (x, y) if u is the xth 
+     *                                element in the sorted order of all unique vertices, lly for v is yth 
+     *                                The layer the edges are already sorted by is relabeled first, 
+     *                                so only one global sort is needed if the edges came sorted
+     */
+    template <typename E>
+      void reduceVertexIds(sortedAdjacency<E> &adjacency, std::size_t &uniqueVertexCount)
+      {
+        const int SRC = 0, DEST = 1;
 
-          //my first vertex id
-          E firstLocalVertexId = std::get<SRC>(edgeList.front());
+        if(adjacency.getPrimaryLayer() == SRC)
+        {
+          relabelLayerContiguous<SRC>(adjacency, uniqueVertexCount);
+          relabelLayerContiguous<DEST>(adjacency, uniqueVertexCount);
+        }
+        else
+        {
+          relabelLayerContiguous<DEST>(adjacency, uniqueVertexCount);
+          relabelLayerContiguous<SRC>(adjacency, uniqueVertexCount);
+        }
+      }
 
-          //Start traversal over vertex array
-          for(auto it = edgeList.begin(); it != edgeList.end();)
-          {
-            //Edges whose dest element are equal
-            auto edgeListRange = conn::utils::findRange(it, edgeList.end(), *it, conn::utils::TpleComp<SRC>()); 
+    /**
+     * @brief     method used to make the vertex ids contiguous
+     */
+    enum reduceIdsEngine
+    {
+      sortBased,    //sorts the edge list by each layer, new ids follow the order of original ids
+      hashBased     //routes the unique ids to owner ranks by hashing, edges are neither moved nor sorted
+    };
 
-            std::for_each(edgeListRange.first, edgeListRange.second, [&](std::pair<E,E> &e){
-                std::get<SRC>(e) = localVertexIndex;
-                });
+    /**
+     * @brief                         Given a graph as list of edges, it updates all the vertex ids so
+     *                                that they are contiguos from 0 to |V-1|, without sorting the edges
+     * @param[in]  edgeList           distributed vector of edges
+     * @param[out] uniqueVertexCount  count of unique vertices
+     * @param[out] uniqueVertexList   if not null, distributed array of original vertex ids 
+     *                                (global index of vertex here is its new id)
+     * @details                       Each unique id is owned by the rank chosen by hashing it, owners number
+     *                                their sorted ids after an exscan of the counts, see idDictionary.
+     *                                New ids are contiguous, but not in the order of the original ids.
+     *                                Edge order and distribution are unchanged
+     */
+    template <typename E>
+      void reduceVertexIdsUsingHash(std::vector<std::pair<E,E>> &edgeList, std::size_t &uniqueVertexCount, 
+          const mxx::comm &comm, std::vector<E> *uniqueVertexList = nullptr)
+      {
+        idDictionary<E> dictionary(edgeList, comm);
 
-            //Adavance the loop variables
-            it = edgeListRange.second;
-            localVertexIndex++;
-          }
+        dictionary.relabel(edgeList);
 
-          E localUniqueVertexCount = localVertexIndex;
+        uniqueVertexCount = dictionary.size();
 
-          E exScanUniqueVertices = 0;
+        //Owned ids are numbered in rank order, which makes them the old ids of the new ids
+        if(uniqueVertexList)
+          *uniqueVertexList = dictionary.getOwnedIds();
+      }
 
-          E nextProcsFirstVertexId = mxx::left_shift(firstLocalVertexId, comm);
-          if(comm.rank() != (comm.size() - 1) && lastLocalVertexId == nextProcsFirstVertexId)
-            localUniqueVertexCount--; //Deduct the extra bucket this rank counted
+    /**
+     * @brief                         Given a graph as list of edges, it updates all the vertex ids so
+     *                                that they are contiguos from 0 to |V-1|
+     * @param[in]  edgeList           distributed vector of edges
+     * @param[out] uniqueVertexCount  count of unique vertices
+     * @param[in]  engine             sortBased leaves the edges sorted by SRC layer
+     */
+    template <typename E>
+      void reduceVertexIds(std::vector<std::pair<E,E>> &edgeList, std::size_t &uniqueVertexCount, const mxx::comm &comm,
+          reduceIdsEngine engine = reduceIdsEngine::sortBased)
+      {
+        if(engine == reduceIdsEngine::hashBased)
+        {
+          reduceVertexIdsUsingHash(edgeList, uniqueVertexCount, comm);
+          return;
+        }
 
-          exScanUniqueVertices = mxx::exscan(localUniqueVertexCount, std::plus<E>(), comm);
-          if(!comm.rank()) exScanUniqueVertices = 0;
+        sortedAdjacency<E> adjacency(edgeList, comm);
+        reduceVertexIds(adjacency, uniqueVertexCount);
+      }
 
-          //Revise all the vertex ids to global index
-          std::for_each(edgeList.begin(), edgeList.end(), [&](std::pair<E,E> &e){
-              std::get<SRC>(e) += exScanUniqueVertices;
-              });
-        }//SRC layer updated
+    /**
+     * @brief                         Given a graph as list of edges, it updates all the vertex ids so
+     *                                that they are contiguos from 0 to |V-1|
+     * @param[in]  edgeList           distributed vector of edges
+     * @param[out] uniqueVertexList   distributed array of original vertex ids (global index of vertex here is its new id)
+     * @details                       Uses the hash based engine, mapping table comes out of it
+     */
+    template <typename E>
+      void reduceVertexIds(std::vector<std::pair<E,E>> &edgeList, std::vector<E> &uniqueVertexList, const mxx::comm &comm)
+      {
+        std::size_t uniqueVertexCount;
+        reduceVertexIdsUsingHash(edgeList, uniqueVertexCount, comm, &uniqueVertexList);
       }
   }
 }
@@ -0,0 +1,257 @@
+/*
+ * Copyright 2016 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    sortedAdjacency.hpp
+ * @ingroup graphGen
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ * @brief   Distributed edge list that remembers its global sort order and partitioning,
+ *          so that the phases between graph construction and BFS never re-sort it
+ *
+ * Copyright (c) 2016 Georgia Institute of Technology. All Rights Reserved.
+ */
+
+#ifndef GRAPH_SORTED_ADJACENCY_HPP
+#define GRAPH_SORTED_ADJACENCY_HPP
+
+//Includes
+#include <mpi.h>
+#include <iostream>
+#include <algorithm>
+
+//Own includes
+#include "utils/commonfuncs.hpp"
+
+//External includes
+#include "mxx/comm.hpp"
+#include "mxx/distribution.hpp"
+#include "mxx/reduction.hpp"
+#include "mxx/sort.hpp"
+
+namespace conn
+{
+  namespace graphGen
+  {
+
+    /**
+     * @class                     conn::graphGen::sortedAdjacency
+     * @brief                     wraps a distributed edge list along with its global sort order
+     * @details                   Sorting requests are skipped if the edges are already in the
+     *                            required order. Offsets of the runs of equal primary layer value
+     *                            (i.e. CSR row offsets, if sorted by SRC) are built lazily.
+     *                            Phases that modify the edge list directly should report the order
+     *                            they leave behind using markModified().
+     * @tparam[in]  E             vertex id type
+     */
+    template <typename E>
+      class sortedAdjacency
+      {
+        public:
+
+          //Used when the order of a layer is unknown
+          static const int NONE = -1;
+
+          //Largest ratio of the local and the average edge count for which
+          //owner partitioned edges are not block decomposed
+          static constexpr double MAX_IMBALANCE = 1.1;
+
+        private:
+
+          //Reference to the distributed edge list
+          std::vector< std::pair<E,E> > &edgeList;
+
+          //Layers by which the edges are globally sorted, NONE if unknown
+          int primaryLayer = NONE;
+          int secondaryLayer = NONE;
+
+          //True if the edges are block decomposed across the ranks
+          bool blockDecomposed = false;
+
+          //True if the edges were routed to the hash owner of their source vertex by
+          //the producer (see edgeRouter), until the edges are first moved
+          bool ownerPartitioned = false;
+
+          //Offsets of the runs of equal primary layer value in the local edges,
+          //last element is edgeList.size()
+          std::vector<std::size_t> runOffsets;
+          bool runOffsetsValid = false;
+
+          //MPI communicator
+          mxx::comm comm;
+
+        public:
+
+          /**
+           * @brief                 constructor
+           * @param[in] edgeList    distributed edge list, order is assumed to be unknown
+           * @param[in] comm        mpi communicator
+           * @param[in] ownerPartitioned  true if the producer routed the edges to their owners
+           */
+          sortedAdjacency(std::vector< std::pair<E,E> > &_edgeList, const mxx::comm &_comm, bool _ownerPartitioned = false)
+            : edgeList(_edgeList), ownerPartitioned(_ownerPartitioned), comm(_comm.copy())
+          {
+          }
+
+          /**
+           * @brief     underlying edge list
+           */
+          std::vector< std::pair<E,E> >& edges()
+          {
+            return edgeList;
+          }
+
+          const mxx::comm& getComm() const
+          {
+            return comm;
+          }
+
+          int getPrimaryLayer() const
+          {
+            return primaryLayer;
+          }
+
+          int getSecondaryLayer() const
+          {
+            return secondaryLayer;
+          }
+
+          /**
+           * @brief     block decompose the edges, preserves the global order
+           * @details   Owner partitioned edges are balanced already, unless the graph has
+           *            heavy vertices. They are left in place if no rank holds more than
+           *            MAX_IMBALANCE times the average count, the sorts do not need an
+           *            exact block decomposition.
+           */
+          void distribute()
+          {
+            if(!blockDecomposed)
+            {
+              if(!ownerPartitioned || !isBalanced())
+                mxx::distribute_inplace(edgeList, comm);
+
+              blockDecomposed = true;
+              ownerPartitioned = false;
+              runOffsetsValid = false;
+            }
+          }
+
+          /**
+           * @brief     globally sort the edges by a single layer, unless already sorted by it
+           */
+          template <int layer>
+            void sortBy()
+            {
+              distribute();
+
+              if(primaryLayer != layer)
+              {
+                //Order may be unknown to us, but still be right
+                if(!mxx::is_sorted(edgeList.begin(), edgeList.end(), conn::utils::TpleComp<layer>(), comm))
+                  mxx::sort(edgeList.begin(), edgeList.end(), conn::utils::TpleComp<layer>(), comm);
+
+                primaryLayer = layer;
+                secondaryLayer = NONE;
+                runOffsetsValid = false;
+              }
+            }
+
+          /**
+           * @brief     globally sort the edges by two layers, unless already sorted by them
+           */
+          template <int layer1, int layer2>
+            void sortBy()
+            {
+              distribute();
+
+              if(primaryLayer != layer1 || secondaryLayer != layer2)
+              {
+                if(!mxx::is_sorted(edgeList.begin(), edgeList.end(), conn::utils::TpleComp2Layers<layer1, layer2>(), comm))
+                  mxx::sort(edgeList.begin(), edgeList.end(), conn::utils::TpleComp2Layers<layer1, layer2>(), comm);
+
+                primaryLayer = layer1;
+                secondaryLayer = layer2;
+                runOffsetsValid = false;
+              }
+            }
+
+          /**
+           * @brief     offsets of the runs of equal primary layer value in the local edges
+           * @details   runs at the rank boundaries may continue on the neighbouring ranks
+           * @note      edges should be sorted using sortBy() first
+           */
+          const std::vector<std::size_t>& getRunOffsets()
+          {
+            assert(primaryLayer != NONE);
+
+            if(!runOffsetsValid)
+            {
+              runOffsets.clear();
+
+              if(primaryLayer == 0)
+                buildRunOffsets<0>();
+              else
+                buildRunOffsets<1>();
+
+              runOffsetsValid = true;
+            }
+
+            return runOffsets;
+          }
+
+          /**
+           * @brief                     record the state of the edges after they were modified outside this class
+           * @param[in] layer1          primary layer of the order kept by the modification, NONE if lost
+           * @param[in] layer2          secondary layer of the order kept by the modification, NONE if lost
+           * @param[in] stillBlockDecomposed  true if the modification kept the block decomposition
+           */
+          void markModified(int layer1 = NONE, int layer2 = NONE, bool stillBlockDecomposed = false)
+          {
+            primaryLayer = layer1;
+            secondaryLayer = layer1 == NONE ? NONE : layer2;
+            blockDecomposed = stillBlockDecomposed;
+            ownerPartitioned = false;
+            runOffsetsValid = false;
+          }
+
+        private:
+
+          bool isBalanced() const
+          {
+            std::size_t localCount = edgeList.size();
+            std::size_t maxCount = mxx::allreduce(localCount, mxx::max<std::size_t>(), comm);
+            std::size_t totalCount = mxx::allreduce(localCount, comm);
+
+            return maxCount <= MAX_IMBALANCE * totalCount / comm.size();
+          }
+
+          template <int layer>
+            void buildRunOffsets()
+            {
+              for(auto it = edgeList.begin(); it != edgeList.end();)
+              {
+                runOffsets.push_back(std::distance(edgeList.begin(), it));
+
+                it = conn::utils::findRunEnd(it, edgeList.end(), conn::utils::TpleComp<layer>());
+              }
+
+              runOffsets.push_back(edgeList.size());
+            }
+      };
+
+  }
+}
+
+#endif
@@ -30,14 +30,29 @@
 #include <mpi.h>
 #include <iostream>
 #include <vector>
+#include <numeric>
+#include <utility>
 
 //Own includes
 #include "graphGen/common/timer.hpp"
+#include "graphGen/common/hashKernels.hpp"
+#include "graphGen/fileIO/inputFiles.hpp"
+#include "graphGen/fileIO/bgzfReader.hpp"
+#include "graphGen/common/edgeRouter.hpp"
+#include "graphGen/deBruijn/kmerEdgeStream.hpp"
+#include "graphGen/deBruijn/unitigCompaction.hpp"
 
 //External includes
+#include "extutils/logging.hpp"
+#include "mxx/comm.hpp"
+#include "mxx/reduction.hpp"
+#include "mxx/sort.hpp"
+#include "mxx_extra/sort.hpp"
 #include "debruijn/de_bruijn_node_trait.hpp"
 #include "debruijn/de_bruijn_construct_engine.hpp"
 #include "debruijn/de_bruijn_nodes_distributed.hpp"
+#include "io/fastq_loader.hpp"
+#include "io/fasta_loader.hpp"
 
 namespace conn 
 {
@@ -46,97 +61,570 @@ namespace conn
     /**
      * @class                     conn::graphGen::deBruijnGraph
      * @brief                     Builds the edgelist of de Bruijn graph 
-     * @details                   Sequences are expected in the FASTQ format
+     * @details                   Sequences are expected in the FASTQ or FASTA format, FASTA
+     *                            records may span multiple lines. Format is detected per file.
      *                            Restrict the alphabets of DNA to {A,C,G,T} 
+     *                            k is chosen at runtime from the values in supportedK().
+     *                            K-mers longer than 32 do not fit in a 64-bit vertex id, their
+     *                            ids are 64-bit fingerprints of all the k-mer words, and the
+     *                            count of distinct fingerprints is checked against the k-mer count.
+     *                            Optionally, non-branching paths are compacted into unitigs
+     *                            (see unitigCompaction) before the edges are emitted.
+     *                            With a minimum abundance above 1, the index counts every edge,
+     *                            and the edges seen fewer times (e.g. due to sequencing errors)
+     *                            are dropped along with the k-mers left without any edge.
+     *                            The index itself is not pruned: all the k-mers are counted, and 
+     *                            the filter is applied as the edges are read out of the index,
+     *                            before any edge tuple is made.
      */
     class deBruijnGraph
     {
       public:
 
-        //Kmer size set to 31, and alphabets set to 4 nucleotides
+        //Alphabets set to 4 nucleotides
         using Alphabet = bliss::common::DNA;
-        using KmerType = bliss::common::Kmer<31, Alphabet>;
 
+        //Kmer and BLISS internal data structure for storing de bruijn graph, for a given k
+        template <unsigned int K>
+          struct kmerTraits
+          {
+            using KmerType = bliss::common::Kmer<K, Alphabet>;
+
+            template <typename EdgeEnc>
+              using NodeMapType = typename bliss::de_bruijn::de_bruijn_nodes_distributed<
+              KmerType, bliss::de_bruijn::node::edge_exists<EdgeEnc>, int,
+              bliss::kmer::transform::lex_less,
+              bliss::kmer::hash::farm>;
 
-        //BLISS internal data structure for storing de bruijn graph
-        template <typename EdgeEnc>
-          using NodeMapType = typename bliss::de_bruijn::de_bruijn_nodes_distributed<
-          KmerType, bliss::de_bruijn::node::edge_exists<EdgeEnc>, int,
-          bliss::kmer::transform::lex_less,
-          bliss::kmer::hash::farm>;
+            //Same index, counting the occurrences of every edge
+            template <typename EdgeEnc>
+              using CountNodeMapType = typename bliss::de_bruijn::de_bruijn_nodes_distributed<
+              KmerType, bliss::de_bruijn::node::edge_counts<EdgeEnc, uint32_t>, int,
+              bliss::kmer::transform::lex_less,
+              bliss::kmer::hash::farm>;
+          };
 
+        //Parser types, depend on the sequence file format
+        template <typename baseIter>
+          using FASTQParser = typename bliss::io::FASTQParser<baseIter>;
 
-        //Parser type, depends on the sequence file format
-        //We restrict the usage to FASTQ format
         template <typename baseIter>
-          using SeqParser = typename bliss::io::FASTQParser<baseIter>;
+          using FASTAParser = typename bliss::io::FASTAParser<baseIter>;
+
+        //Values of k compiled in, each one instantiates the BLISS index
+        static std::vector<unsigned int> supportedK()
+        {
+          return {21, 31, 41, 51, 63};
+        }
+
+      private:
+
+        //Kmer size
+        unsigned int k;
+
+        //Switch to generate the edges while scanning the sequences, without the k-mer index
+        bool streaming;
+
+        //Switch to replace the non-branching paths by single vertices
+        bool compactUnitigs;
 
+        //Edges seen fewer times are dropped, 1 keeps all the edges
+        unsigned int minAbundance;
+
+      public:
+
+        /**
+         * @brief                 constructor
+         * @param[in]   k         kmer size, one of supportedK(), or at most 32 if streaming
+         * @param[in]   streaming generate the edges with kmerEdgeStream, the edges are
+         *                        always routed to the owner of their source vertex
+         * @param[in]   compactUnitigs  emit a single vertex per unitig, requires the k-mer index,
+         *                        i.e. not supported with streaming
+         * @param[in]   minAbundance  minimum count of an edge, edges and k-mers below it are
+         *                        dropped, requires the k-mer index as well
+         */
+        deBruijnGraph(unsigned int k = 31, bool streaming = false, bool compactUnitigs = false, unsigned int minAbundance = 1)
+          : k(k), streaming(streaming), compactUnitigs(compactUnitigs), minAbundance(minAbundance)
+        {
+        }
 
         /** 
          * @brief                 populates the edge list vector 
-         * @param[in]   fileName
+         * @param[in]   fileName    file, or comma separated list of files, directories
+         *                          or glob patterns (see listInputFiles())
          * @param[out]  edgelist
+         * @param[in]   permuteIds  permute the vertex ids while adding the edges, 
+         *                          same as calling permuteVectorIds() later
+         * @param[in]   routeToOwner  send each edge to the hash owner of its source vertex,
+         *                          see edgeRouter
          */
         template <typename E>
         void populateEdgeList( std::vector< std::pair<E, E> > &edgeList, 
             std::string &fileName,
-            const mxx::comm &comm)
+            const mxx::comm &comm,
+            bool permuteIds = false,
+            bool routeToOwner = false)
+        {
+          //Sequences are read uncompressed, by the bliss loaders or by the streaming scan
+          for(auto &f : listInputFiles(fileName, comm))
+            if(!comm.rank() && bgzf::isBgzfFile(f))
+              abortOnInputError("BGZF compressed sequences are not supported, decompress " + f + " first", comm);
+
+          if(streaming)
+          {
+            LOG_IF(!comm.rank() && compactUnitigs, WARNING) << "Unitig compaction needs the k-mer index, skipped while streaming";
+            LOG_IF(!comm.rank() && minAbundance > 1, WARNING) << "Abundance filter needs the k-mer index, skipped while streaming";
+
+            kmerEdgeStream<E> stream(comm, k, permuteIds);
+            stream.populateEdgeList(edgeList, fileName);
+            return;
+          }
+
+          switch(k)
+          {
+            case 21: buildEdgeList<21>(edgeList, fileName, comm, permuteIds, routeToOwner); break;
+            case 31: buildEdgeList<31>(edgeList, fileName, comm, permuteIds, routeToOwner); break;
+            case 41: buildEdgeList<41>(edgeList, fileName, comm, permuteIds, routeToOwner); break;
+            case 51: buildEdgeList<51>(edgeList, fileName, comm, permuteIds, routeToOwner); break;
+            case 63: buildEdgeList<63>(edgeList, fileName, comm, permuteIds, routeToOwner); break;
+            default:
+              if(!comm.rank()) 
+              {
+                std::cerr << "k = " << k << " is not supported, use one of";
+                for(auto supported : supportedK()) std::cerr << " " << supported;
+                std::cerr << std::endl;
+              }
+              MPI_Abort(comm, 1);
+          }
+        }
+
+      private:
+
+        /**
+         * @brief                 populateEdgeList() for kmer size K, edge counts are kept
+         *                        only if they are needed for the abundance filter
+         */
+        template <unsigned int K, typename E>
+        void buildEdgeList( std::vector< std::pair<E, E> > &edgeList, 
+            std::string &fileName,
+            const mxx::comm &comm,
+            bool permuteIds,
+            bool routeToOwner)
+        {
+          if(minAbundance > 1)
+            buildEdgeList<kmerTraits<K>::template CountNodeMapType>(edgeList, fileName, comm, permuteIds, routeToOwner);
+          else
+            buildEdgeList<kmerTraits<K>::template NodeMapType>(edgeList, fileName, comm, permuteIds, routeToOwner);
+        }
+
+        /**
+         * @brief                 populateEdgeList() over the index type MapType
+         */
+        template <template <typename> class MapType, typename E>
+        void buildEdgeList( std::vector< std::pair<E, E> > &edgeList, 
+            std::string &fileName,
+            const mxx::comm &comm,
+            bool permuteIds,
+            bool routeToOwner)
         {
           Timer timer;
 
           //Initialize the map
-          bliss::de_bruijn::de_bruijn_engine<NodeMapType> idx(comm);
-
-          //Build the de Bruijn graph as distributed map
-          idx.template build<SeqParser>(fileName, comm);
+          bliss::de_bruijn::de_bruijn_engine<MapType> idx(comm);
 
-          auto it = idx.cbegin();
+          //Build the de Bruijn graph as distributed map, k-mers of all the files
+          //are inserted into the same map
+          for(auto &f : listInputFiles(fileName, comm))
+          {
+            if(isFastaFile(f, comm))
+              idx.template build<FASTAParser>(f, comm);
+            else
+              idx.template build<FASTQParser>(f, comm);
+          }
 
           //Deriving data type of de Bruijn graph storage container
-          using mapPairType = typename std::iterator_traits<decltype(it)>::value_type;
+          using mapPairType = typename std::iterator_traits<decltype(idx.cbegin())>::value_type;
           using constkmerType =  typename std::tuple_element<0, mapPairType>::type; 
           using kmerType = typename std::remove_const<constkmerType>::type; //Remove const from nodetype
-          using edgeCountInfoType = typename std::tuple_element<1, mapPairType>::type;
 
+          static_assert(std::is_same<typename kmerType::KmerWordType, uint64_t>::value, "Kmer word type should be set to uint64_t");
+
+          //Ids of the local k-mers, kept only to check the fingerprints for collisions
+          std::vector<uint64_t> fingerprints;
+
+          //Count of k-mers, and of those left without any edge by the abundance filter
+          std::size_t kmerCount = 0, droppedCount = 0;
+
+          edgeRouter<E> router(edgeList, comm, routeToOwner);
+
+          //Neighbors are held till the chains are labeled, if compacting
+          unitigCompaction<E> compaction(comm);
+
+          if(compactUnitigs)
+          {
+            addToCompaction<kmerType>(idx, compaction, fingerprints, kmerCount, droppedCount, permuteIds);
+            compaction.populateEdgeList(router);
+          }
+          else if(routeToOwner)
+            routeEdges<kmerType>(idx, router, fingerprints, kmerCount, droppedCount, permuteIds);
+          else
+            extractEdges<kmerType>(idx, edgeList, fingerprints, kmerCount, droppedCount, permuteIds);
+
+          router.finish();
+
+          if(minAbundance > 1)
+          {
+            kmerCount = mxx::reduce(kmerCount, 0, comm);
+            droppedCount = mxx::reduce(droppedCount, 0, comm);
+
+            LOG_IF(!comm.rank(), INFO) << droppedCount << " of " << kmerCount << " k-mers dropped, no edge seen at least " << minAbundance << " times";
+          }
+
+          if(kmerType::nWords > 1)
+            checkFingerprints(fingerprints, comm);
+
+          timer.end_section("graph generation completed");
+        }
+
+        /**
+         * @brief                 reads the edges of the local k-mers out of the index, using all
+         *                        the threads
+         * @param[out]  edges     edges are appended to this vector
+         * @details               The index iterator is forward only, block boundaries are recorded
+         *                        in a single sequential pass. Threads then count the edges of every
+         *                        block, the vector is resized once, and the blocks are filled in
+         *                        parallel at their offsets. Edge order is the same as a sequential walk.
+         */
+        template <typename KmerType, typename IndexType, typename E>
+        void extractEdges(IndexType &idx,
+            std::vector< std::pair<E, E> > &edges,
+            std::vector<uint64_t> &fingerprints,
+            std::size_t &kmerCount,
+            std::size_t &droppedCount,
+            bool permuteIds) const
+        {
+          std::size_t localCount = 0;
+          auto blockBegin = getBlockBoundaries(idx, localCount);
+          const std::ptrdiff_t blockCount = blockBegin.size() - 1;
+
+          //Count of edges and of kept k-mers in every block, prefix sums after the first pass
+          std::vector<std::size_t> edgeOffsets(blockCount + 1, 0);
+          std::vector<std::size_t> kmerOffsets(blockCount + 1, 0);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+          {
+            //Temporary storage for each kmer's neighbors in the graph
+            std::vector<KmerType> inNeighbors, outNeighbors;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+            for(std::ptrdiff_t b = 0; b < blockCount; b++)
+              for(auto it = blockBegin[b]; it != blockBegin[b+1]; it++)
+              {
+                getNeighbors(it->first, it->second, inNeighbors, outNeighbors);
+
+                if(minAbundance > 1 && inNeighbors.empty() && outNeighbors.empty())
+                  continue;
+
+                edgeOffsets[b+1] += inNeighbors.size() + outNeighbors.size();
+                kmerOffsets[b+1]++;
+              }
+          }
+
+          std::partial_sum(edgeOffsets.begin(), edgeOffsets.end(), edgeOffsets.begin());
+          std::partial_sum(kmerOffsets.begin(), kmerOffsets.end(), kmerOffsets.begin());
+
+          kmerCount += localCount;
+          droppedCount += localCount - kmerOffsets.back();
+
+          //Single allocation for the edges of this rank
+          std::size_t initialSize = edges.size();
+          edges.resize(initialSize + edgeOffsets.back());
+
+          if(KmerType::nWords > 1)
+            fingerprints.resize(kmerOffsets.back());
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+          {
+            std::vector<KmerType> inNeighbors, outNeighbors;
+
+            bliss::kmer::transform::lex_less<KmerType> minKmer;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+            for(std::ptrdiff_t b = 0; b < blockCount; b++)
+            {
+              auto edge = edges.begin() + initialSize + edgeOffsets[b];
+              std::size_t kmerIndex = kmerOffsets[b];
+
+              for(auto it = blockBegin[b]; it != blockBegin[b+1]; it++)
+              {
+                getNeighbors(it->first, it->second, inNeighbors, outNeighbors);
+
+                if(minAbundance > 1 && inNeighbors.empty() && outNeighbors.empty())
+                  continue;
+
+                E s = vertexId(minKmer(it->first));
+                if(KmerType::nWords > 1) fingerprints[kmerIndex++] = s;
+                if(permuteIds) s = permuteId(s);
+
+                for(auto *neighbors : {&inNeighbors, &outNeighbors})
+                  for(auto &e : *neighbors)
+                  {
+                    E d = vertexId(minKmer(e));
+                    if(permuteIds) d = permuteId(d);
+                    *edge++ = std::make_pair(s, d);
+                  }
+              }
+            }
+          }
+        }
+
+        /**
+         * @brief                 sends the edges of the local k-mers to the owner ranks through the
+         *                        router, using all the threads
+         * @details               Threads fill the edges of one block at a time, and the blocks are
+         *                        pushed to the router in block order as soon as they are complete.
+         *                        Memory used is a block of edges per thread, the edges of this rank
+         *                        are never held together. Edge order is the same as a sequential walk.
+         */
+        template <typename KmerType, typename IndexType, typename E>
+        void routeEdges(IndexType &idx,
+            edgeRouter<E> &router,
+            std::vector<uint64_t> &fingerprints,
+            std::size_t &kmerCount,
+            std::size_t &droppedCount,
+            bool permuteIds) const
+        {
+          std::size_t localCount = 0;
+          auto blockBegin = getBlockBoundaries(idx, localCount);
+          const std::ptrdiff_t blockCount = blockBegin.size() - 1;
+
+          kmerCount += localCount;
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+          {
+            std::vector<KmerType> inNeighbors, outNeighbors;
+
+            //Edges and fingerprints of the block being filled by this thread
+            std::vector< std::pair<E, E> > blockEdges;
+            std::vector<uint64_t> blockFingerprints;
+
+            bliss::kmer::transform::lex_less<KmerType> minKmer;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic) ordered
+#endif
+            for(std::ptrdiff_t b = 0; b < blockCount; b++)
+            {
+              blockEdges.clear();
+              blockFingerprints.clear();
+
+              std::size_t blockDropped = 0;
+
+              for(auto it = blockBegin[b]; it != blockBegin[b+1]; it++)
+              {
+                getNeighbors(it->first, it->second, inNeighbors, outNeighbors);
+
+                if(minAbundance > 1 && inNeighbors.empty() && outNeighbors.empty())
+                {
+                  blockDropped++;
+                  continue;
+                }
+
+                E s = vertexId(minKmer(it->first));
+                if(KmerType::nWords > 1) blockFingerprints.push_back(s);
+                if(permuteIds) s = permuteId(s);
+
+                for(auto *neighbors : {&inNeighbors, &outNeighbors})
+                  for(auto &e : *neighbors)
+                  {
+                    E d = vertexId(minKmer(e));
+                    if(permuteIds) d = permuteId(d);
+                    blockEdges.emplace_back(s, d);
+                  }
+              }
+
+              //Router is used by one thread at a time, in block order
+#ifdef _OPENMP
+#pragma omp ordered
+#endif
+              {
+                droppedCount += blockDropped;
+                fingerprints.insert(fingerprints.end(), blockFingerprints.begin(), blockFingerprints.end());
+
+                for(auto &e : blockEdges)
+                  router.push(e.first, e.second);
+              }
+            }
+          }
+        }
+
+        /**
+         * @brief                 iterators to the beginning of every block of k-mers in the index,
+         *                        followed by the end iterator
+         * @param[out]  localCount  count of k-mers in the index
+         * @details               The index iterator is forward only, so the boundaries are recorded
+         *                        in a single sequential pass
+         */
+        template <typename IndexType>
+        std::vector< decltype(std::declval<IndexType&>().cbegin()) > getBlockBoundaries(IndexType &idx, std::size_t &localCount) const
+        {
+          //K-mers per block, large enough to amortize the scheduling
+          const std::size_t blockSize = 1UL << 12;
+
+          std::vector< decltype(idx.cbegin()) > blockBegin;
+
+          for(auto it = idx.cbegin(); it != idx.cend(); it++, localCount++)
+            if(localCount % blockSize == 0)
+              blockBegin.push_back(it);
+
+          blockBegin.push_back(idx.cend());
+
+          return blockBegin;
+        }
+
+        /**
+         * @brief                 adds the local k-mers and their neighbors to the unitig compaction
+         */
+        template <typename KmerType, typename IndexType, typename E>
+        void addToCompaction(IndexType &idx,
+            unitigCompaction<E> &compaction,
+            std::vector<uint64_t> &fingerprints,
+            std::size_t &kmerCount,
+            std::size_t &droppedCount,
+            bool permuteIds) const
+        {
           //Temporary storage for each kmer's neighbors in the graph
-          std::vector<kmerType> tmpNeighborVector1;
-          std::vector<kmerType> tmpNeighborVector2;
+          std::vector<KmerType> inNeighbors, outNeighbors;
+          std::vector<E> adjacent;
 
           bliss::kmer::transform::lex_less<KmerType> minKmer;
 
-          static_assert(std::is_same<typename kmerType::KmerWordType, uint64_t>::value, "Kmer word type should be set to uint64_t");
-
-          //Read the index and populate the edges inside edgeList
-          for(; it != idx.cend(); it++)
+          for(auto it = idx.cbegin(); it != idx.cend(); it++)
           {
-            auto sourceKmer = it->first;
+            kmerCount++;
+
+            getNeighbors(it->first, it->second, inNeighbors, outNeighbors);
+
+            if(minAbundance > 1 && inNeighbors.empty() && outNeighbors.empty())
+            {
+              droppedCount++;
+              continue;
+            }
+
+            E s = vertexId(minKmer(it->first));
+            if(KmerType::nWords > 1) fingerprints.push_back(s);
+            if(permuteIds) s = permuteId(s);
+
+            adjacent.clear();
+
+            for(auto *neighbors : {&inNeighbors, &outNeighbors})
+              for(auto &e : *neighbors)
+              {
+                E d = vertexId(minKmer(e));
+                if(permuteIds) d = permuteId(d);
+                adjacent.push_back(d);
+              }
+
+            compaction.addKmer(s, adjacent, inNeighbors.size() <= 1 && outNeighbors.size() <= 1);
+          }
+        }
 
-            //Get incoming neighbors
-            bliss::de_bruijn::node::node_utils<kmerType, edgeCountInfoType>::get_in_neighbors(sourceKmer, it->second, tmpNeighborVector1);
+        /**
+         * @brief                 in and out neighbors of a k-mer in the index without counts
+         */
+        template <typename KmerType, typename EdgeEnc>
+          void getNeighbors(const KmerType &kmer, const bliss::de_bruijn::node::edge_exists<EdgeEnc> &node,
+              std::vector<KmerType> &inNeighbors, std::vector<KmerType> &outNeighbors) const
+          {
+            using nodeUtils = bliss::de_bruijn::node::node_utils<KmerType, bliss::de_bruijn::node::edge_exists<EdgeEnc> >;
 
-            //Get outgoing neigbors
-            bliss::de_bruijn::node::node_utils<kmerType, edgeCountInfoType>::get_out_neighbors(sourceKmer, it->second, tmpNeighborVector2);
+            nodeUtils::get_in_neighbors(kmer, node, inNeighbors);
+            nodeUtils::get_out_neighbors(kmer, node, outNeighbors);
+          }
 
-            //typename kmerType::KmerWordType* sourceVertexData = minKmer(sourceKmer).getData();
-            auto s = minKmer(sourceKmer).getData()[0];
+        /**
+         * @brief                 in and out neighbors of a k-mer over the edges counted at least
+         *                        minAbundance times
+         * @details               Edge counts are indexed by the edge encoding of the base added to 
+         *                        the k-mer, at the end for the out edges and at the front for the in 
+         *                        edges. K-mers are extended with the code of the same base in Alphabet,
+         *                        both are matched through the ASCII character of the base.
+         */
+        template <typename KmerType, typename EdgeEnc, typename CountType>
+          void getNeighbors(const KmerType &kmer, const bliss::de_bruijn::node::edge_counts<EdgeEnc, CountType> &node,
+              std::vector<KmerType> &inNeighbors, std::vector<KmerType> &outNeighbors) const
+          {
+            inNeighbors.clear();
+            outNeighbors.clear();
 
-            //Push the edges to our edgeList
-            for(auto &e : tmpNeighborVector1)
+            for(uint8_t c = 0; c < bliss::common::AlphabetTraits<Alphabet>::getSize(); c++)
             {
+              uint8_t e = EdgeEnc::FROM_ASCII[static_cast<uint8_t>(Alphabet::TO_ASCII[c])];
+
+              if(node.get_in_edge_frequency(e) >= minAbundance)
+              {
+                inNeighbors.push_back(kmer);
+                inNeighbors.back().nextReverseFromChar(c);
+              }
 
-              auto d = minKmer(e).getData()[0];
-              edgeList.emplace_back(s, d);
+              if(node.get_out_edge_frequency(e) >= minAbundance)
+              {
+                outNeighbors.push_back(kmer);
+                outNeighbors.back().nextFromChar(c);
+              }
             }
+          }
+
+        /**
+         * @brief                 vertex id of a kmer, the kmer itself if it fits in a single word,
+         *                        else a fingerprint of its words
+         */
+        template <typename KmerType>
+          static uint64_t vertexId(KmerType kmer)
+          {
+            if(KmerType::nWords == 1)
+              return kmer.getData()[0];
 
-            //Same procedure for the outgoing edges
-            for(auto &e : tmpNeighborVector2)
+            uint64_t id = 0;
+            for(unsigned int i = 0; i < KmerType::nWords; i++)
             {
-              auto d = minKmer(e).getData()[0];
-              edgeList.emplace_back(s, d);
+              id ^= kmer.getData()[i];
+              hash_64(id);
             }
+
+            return id;
           }
 
-          timer.end_section("graph generation completed");
+        /**
+         * @brief                 counts the distinct fingerprints of the k-mers, each k-mer is
+         *                        present on a single rank
+         * @details               K-mers sharing a fingerprint become a single vertex, which may
+         *                        join their components. Collisions are reported, the graph is kept.
+         */
+        static void checkFingerprints(std::vector<uint64_t> &fingerprints, const mxx::comm &comm)
+        {
+          std::size_t kmerCount = mxx::allreduce(fingerprints.size(), comm);
+
+          comm.with_subset(fingerprints.size() > 0, [&](const mxx::comm &comm){
+              mxx::sort(fingerprints.begin(), fingerprints.end(), std::less<uint64_t>(), comm);
+              });
+
+          std::size_t distinctCount = mxx::uniqueCount(fingerprints.begin(), fingerprints.end(), std::less<uint64_t>(), comm);
+
+          if(distinctCount < kmerCount)
+            LOG_IF(!comm.rank(), WARNING) << kmerCount - distinctCount << " of " << kmerCount << " k-mers share their 64-bit vertex id with another k-mer";
+          else
+            LOG_IF(!comm.rank(), INFO) << "Vertex ids of all " << kmerCount << " k-mers are distinct";
         }
 
     };
@@ -0,0 +1,493 @@
+/*
+ * Copyright 2016 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    kmerEdgeStream.hpp
+ * @ingroup graphGen
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ * @brief   Builds the de Bruijn graph edges directly while scanning the sequences,
+ *          without a distributed k-mer index
+ *
+ * Copyright (c) 2016 Georgia Institute of Technology. All Rights Reserved.
+ */
+
+#ifndef DE_BRUIJN_KMER_EDGE_STREAM_HPP
+#define DE_BRUIJN_KMER_EDGE_STREAM_HPP
+
+//Includes
+#include <mpi.h>
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+
+//Own includes
+#include "graphGen/common/timer.hpp"
+#include "graphGen/common/hashKernels.hpp"
+#include "graphGen/common/edgeRouter.hpp"
+#include "graphGen/fileIO/inputFiles.hpp"
+
+//External includes
+#include "extutils/logging.hpp"
+#include "mxx/comm.hpp"
+#include "mxx/reduction.hpp"
+
+namespace conn
+{
+  namespace graphGen
+  {
+
+    /**
+     * @brief     rolling 2-bit encoding of the last k bases and of their reverse complement
+     */
+    struct kmerWindow
+    {
+      unsigned int k;
+
+      //Forward and reverse complement k-mers
+      uint64_t fwd = 0, rev = 0;
+
+      //Count of consecutive bases pushed since the last reset
+      std::size_t length = 0;
+
+      kmerWindow(unsigned int _k) : k(_k)
+      {
+      }
+
+      /**
+       * @brief     2-bit code of a nucleotide, -1 for other characters (e.g. N)
+       */
+      static int baseCode(char c)
+      {
+        switch(c)
+        {
+          case 'A': case 'a': return 0;
+          case 'C': case 'c': return 1;
+          case 'G': case 'g': return 2;
+          case 'T': case 't': return 3;
+          default: return -1;
+        }
+      }
+
+      void reset()
+      {
+        length = 0;
+      }
+
+      /**
+       * @brief     appends a base, the window is reset if the character is not a nucleotide
+       * @return    false if the window was reset
+       */
+      bool push(char c)
+      {
+        int code = baseCode(c);
+
+        if(code < 0)
+        {
+          length = 0;
+          return false;
+        }
+
+        uint64_t mask = k == 32 ? ~0ULL : (1ULL << (2 * k)) - 1;
+
+        fwd = ((fwd << 2) | code) & mask;
+        rev = (rev >> 2) | (static_cast<uint64_t>(3 - code) << (2 * (k - 1)));
+        length++;
+
+        return true;
+      }
+
+      /**
+       * @brief     lexicographically smaller of the k-mer and its reverse complement
+       */
+      uint64_t canonical() const
+      {
+        return std::min(fwd, rev);
+      }
+    };
+
+    /**
+     * @class     conn::graphGen::kmerEdgeStream
+     * @brief     Generates the edges between the canonical k-mers adjacent in the sequences
+     * @details   Every rank scans its share of each file, and sends the edges (both ways) to the
+     *            owner of their source k-mer using edgeRouter. Owners remove the duplicate edges,
+     *            repeatedly while receiving, so that the memory stays proportional to the count
+     *            of distinct edges. No k-mer map is built.
+     *            FASTQ records (4 lines) belong to the rank whose share contains their first
+     *            character. FASTA records may span multiple lines and are split across ranks,
+     *            an edge belongs to the rank whose share contains its first base.
+     *            Vertex ids are the 2-bit encoded canonical k-mers, so k is at most 32.
+     */
+    template <typename E>
+      class kmerEdgeStream
+      {
+        private:
+
+          //Kmer size
+          unsigned int k;
+
+          //Switch to permute the vertex ids, same as calling permuteVectorIds() later
+          bool permuteIds;
+
+          //MPI communicator
+          mxx::comm comm;
+
+          //Received edges are deduplicated once they grow beyond twice the size
+          //after the last deduplication
+          std::size_t dedupThreshold;
+
+          //Count of edges generated by this rank, including duplicates
+          std::size_t generatedCount = 0;
+
+          //Size of the range searched when looking for record or line boundaries
+          static const std::size_t SEARCH_WINDOW = 1UL << 16;
+
+        public:
+
+          /**
+           * @brief                 constructor
+           * @param[in] k           kmer size, 1 to 32
+           * @param[in] permuteIds  permute the vertex ids while generating the edges
+           */
+          kmerEdgeStream(const mxx::comm &_comm, unsigned int _k, bool _permuteIds = false)
+            : k(_k), permuteIds(_permuteIds), comm(_comm.copy())
+          {
+          }
+
+          /**
+           * @brief                 populates the edge list vector
+           * @param[out] edgeList   distributed edge list, partitioned by the owner of the source vertex
+           * @param[in]  fileName   FASTQ or FASTA file, or comma separated list of files, directories
+           *                        or glob patterns (see listInputFiles())
+           */
+          void populateEdgeList(std::vector< std::pair<E,E> > &edgeList, const std::string &fileName)
+          {
+            if(k == 0 || k > 32)
+            {
+              if(!comm.rank()) std::cerr << "k = " << k << " is not supported while streaming, use 1 to 32" << std::endl;
+              MPI_Abort(comm, 1);
+            }
+
+            Timer timer;
+
+            std::size_t initialSize = edgeList.size();
+            dedupThreshold = 1UL << 20;
+
+            edgeRouter<E> router(edgeList, comm);
+
+            std::vector<std::string> files = listInputFiles(fileName, comm);
+            std::vector<std::size_t> fileSizes = getFileSizes(files, comm);
+
+            //Formats are detected before any edge is routed
+            std::vector<bool> fastaFiles;
+            for(auto &f : files)
+              fastaFiles.push_back(isFastaFile(f, comm));
+
+            auto emit = [&](uint64_t kmer1, uint64_t kmer2)
+            {
+              //Palindromes and repeats like AAA...A are adjacent to themselves
+              if(kmer1 == kmer2)
+                return;
+
+              E u = kmer1, v = kmer2;
+
+              if(permuteIds)
+              {
+                u = permuteId(u);
+                v = permuteId(v);
+              }
+
+              router.push(u, v);
+              router.push(v, u);
+
+              generatedCount += 2;
+
+              if(edgeList.size() - initialSize > dedupThreshold)
+                removeDuplicates(edgeList, initialSize);
+            };
+
+            for(std::size_t i = 0; i < files.size(); i++)
+            {
+              std::size_t p = comm.size(), rank = comm.rank();
+              std::size_t shareBegin = fileSizes[i] * rank / p;
+              std::size_t shareEnd = fileSizes[i] * (rank + 1) / p;
+
+              bool fasta = fastaFiles[i];
+
+              if(shareBegin == shareEnd)
+                continue;
+
+              int fd = open(files[i].c_str(), O_RDONLY);
+              if(fd < 0)
+              {
+                std::cerr << "Unable to open file " << files[i] << std::endl;
+                MPI_Abort(comm, 1);
+              }
+
+              if(fasta)
+                scanFasta(fd, fileSizes[i], shareBegin, shareEnd, emit);
+              else
+                scanFastq(fd, fileSizes[i], shareBegin, shareEnd, emit);
+
+              close(fd);
+            }
+
+            router.finish();
+
+            dedupThreshold = 0;
+            removeDuplicates(edgeList, initialSize);
+
+            std::size_t totalGenerated = mxx::reduce(generatedCount, 0, comm);
+            std::size_t totalDistinct = mxx::reduce(edgeList.size() - initialSize, 0, comm);
+
+            LOG_IF(!comm.rank(), INFO) << "Generated " << totalGenerated << " k-mer edges, " << totalDistinct << " distinct";
+
+            timer.end_section("File IO completed, graph built (streaming)");
+          }
+
+        private:
+
+          /**
+           * @brief     sort and remove the duplicates among the edges appended after initialSize
+           */
+          void removeDuplicates(std::vector< std::pair<E,E> > &edgeList, std::size_t initialSize)
+          {
+            std::sort(edgeList.begin() + initialSize, edgeList.end());
+            edgeList.erase(std::unique(edgeList.begin() + initialSize, edgeList.end()), edgeList.end());
+
+            dedupThreshold = std::max(dedupThreshold, 2 * (edgeList.size() - initialSize));
+          }
+
+          /**
+           * @brief     reads [from, to) of a file
+           */
+          static std::vector<char> readRange(int fd, std::size_t from, std::size_t to)
+          {
+            std::vector<char> buffer(to - from);
+
+            for(std::size_t done = 0; done < buffer.size();)
+            {
+              ssize_t n = pread(fd, buffer.data() + done, buffer.size() - done, from + done);
+              if(n <= 0) { buffer.resize(done); break; }
+              done += n;
+            }
+
+            return buffer;
+          }
+
+          /**
+           * @brief     offset of the first FASTQ record beginning at or after pos
+           * @details   A record begins at a line starting with '@', with the line two lines
+           *            below starting with '+'. A quality line starting with '@' is followed
+           *            by a header and a sequence line, so it is never mistaken for a record.
+           */
+          static std::size_t findFastqRecord(int fd, std::size_t fileSize, std::size_t pos)
+          {
+            if(pos == 0 || pos >= fileSize)
+              return std::min(pos, fileSize);
+
+            for(std::size_t window = SEARCH_WINDOW; ; window *= 2)
+            {
+              std::size_t from = pos - 1;
+              std::size_t to = std::min(fileSize, from + window);
+              std::vector<char> buffer = readRange(fd, from, to);
+
+              //Line starts in the buffer, at or after pos
+              std::vector<std::size_t> lineStarts;
+              for(std::size_t i = 0; i + 1 < buffer.size(); i++)
+                if(buffer[i] == '\n')
+                  lineStarts.push_back(i + 1);
+
+              for(std::size_t l = 0; l + 2 < lineStarts.size(); l++)
+                if(buffer[lineStarts[l]] == '@' && buffer[lineStarts[l+2]] == '+')
+                  return from + lineStarts[l];
+
+              if(to == fileSize)
+                return fileSize;
+            }
+          }
+
+          /**
+           * @brief     offset of the beginning of the line containing pos
+           * @details   Steps backwards one window at a time, so that the memory used
+           *            doesn't depend on the line length
+           */
+          static std::size_t findLineStart(int fd, std::size_t pos)
+          {
+            for(std::size_t to = pos; to > 0;)
+            {
+              std::size_t from = to > SEARCH_WINDOW ? to - SEARCH_WINDOW : 0;
+              std::vector<char> buffer = readRange(fd, from, to);
+
+              for(std::size_t i = buffer.size(); i > 0; i--)
+                if(buffer[i-1] == '\n')
+                  return from + i;
+
+              to = from;
+            }
+
+            return 0;
+          }
+
+          /**
+           * @brief     reads the FASTQ records beginning in [shareBegin, shareEnd)
+           */
+          template <typename F>
+            void scanFastq(int fd, std::size_t fileSize, std::size_t shareBegin, std::size_t shareEnd, F &emit)
+            {
+              std::size_t recordsBegin = findFastqRecord(fd, fileSize, shareBegin);
+              std::size_t recordsEnd = findFastqRecord(fd, fileSize, shareEnd);
+
+              if(recordsBegin >= recordsEnd)
+                return;
+
+              std::vector<char> buffer = readRange(fd, recordsBegin, recordsEnd);
+
+              auto curr = buffer.begin();
+              auto skipLine = [&]() {
+                curr = std::find(curr, buffer.end(), '\n');
+                if(curr != buffer.end()) curr++;
+              };
+
+              kmerWindow window(k);
+
+              while(curr != buffer.end())
+              {
+                //Header
+                skipLine();
+
+                //Sequence
+                window.reset();
+                uint64_t previous = 0;
+
+                for(; curr != buffer.end() && *curr != '\n'; curr++)
+                {
+                  if(window.push(*curr) && window.length >= k)
+                  {
+                    if(window.length > k)
+                      emit(previous, window.canonical());
+
+                    previous = window.canonical();
+                  }
+                }
+
+                if(curr != buffer.end()) curr++;
+
+                //'+' and quality lines
+                skipLine();
+                skipLine();
+              }
+            }
+
+          /**
+           * @brief     generates the edges whose first base is in [shareBegin, shareEnd)
+           */
+          template <typename F>
+            void scanFasta(int fd, std::size_t fileSize, std::size_t shareBegin, std::size_t shareEnd, F &emit)
+            {
+              //First character of the line containing shareBegin tells if it is a header,
+              //the rest of that line before shareBegin is not needed
+              bool header = false;
+              std::size_t lineBegin = findLineStart(fd, shareBegin);
+
+              if(lineBegin < shareBegin)
+              {
+                std::vector<char> first = readRange(fd, lineBegin, lineBegin + 1);
+                header = first.size() == 1 && (first[0] == '>' || first[0] == ';');
+              }
+
+              //An edge beginning in the share may end k bases after it, bases are counted
+              //till a header line
+              std::size_t readEnd = shareEnd;
+              for(std::size_t window = SEARCH_WINDOW; readEnd < fileSize; window *= 2)
+              {
+                std::vector<char> buffer = readRange(fd, shareEnd, std::min(fileSize, shareEnd + window));
+
+                std::size_t bases = 0, i = 0;
+                bool lineStart = false;
+
+                for(; i < buffer.size() && bases < k; i++)
+                {
+                  if(lineStart && (buffer[i] == '>' || buffer[i] == ';'))
+                    break;
+
+                  lineStart = buffer[i] == '\n';
+
+                  if(buffer[i] != '\n' && buffer[i] != '\r')
+                    bases++;
+                }
+
+                readEnd = shareEnd + i;
+
+                if(i < buffer.size() || shareEnd + buffer.size() == fileSize)
+                  break;
+              }
+
+              std::vector<char> buffer = readRange(fd, shareBegin, readEnd);
+
+              kmerWindow window(k);
+
+              //Offsets of the last k+1 bases, the first one is the beginning of the edge
+              std::vector<std::size_t> baseOffsets(k + 1);
+
+              uint64_t previous = 0;
+              bool lineStart = lineBegin == shareBegin;
+
+              for(std::size_t i = 0; i < buffer.size(); i++)
+              {
+                char c = buffer[i];
+                std::size_t offset = shareBegin + i;
+
+                if(lineStart && (c == '>' || c == ';'))
+                {
+                  header = true;
+                  window.reset();
+                }
+
+                lineStart = c == '\n';
+
+                if(lineStart)
+                  header = false;
+
+                if(header || lineStart || c == '\r')
+                  continue;
+
+                if(!window.push(c))
+                  continue;
+
+                baseOffsets[window.length % (k + 1)] = offset;
+
+                if(window.length > k)
+                {
+                  if(baseOffsets[(window.length - k) % (k + 1)] >= shareEnd)
+                    break;
+
+                  emit(previous, window.canonical());
+                }
+
+                if(window.length >= k)
+                  previous = window.canonical();
+              }
+            }
+      };
+
+  }
+}
+
+#endif
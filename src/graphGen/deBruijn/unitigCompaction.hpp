@@ -0,0 +1,482 @@
+/*
+ * Copyright 2016 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    unitigCompaction.hpp
+ * @ingroup graphGen
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ * @brief   Compacts the non-branching paths of the de Bruijn graph into unitigs,
+ *          before the edge list is built
+ *
+ * Copyright (c) 2016 Georgia Institute of Technology. All Rights Reserved.
+ */
+
+#ifndef DE_BRUIJN_UNITIG_COMPACTION_HPP
+#define DE_BRUIJN_UNITIG_COMPACTION_HPP
+
+//Includes
+#include <mpi.h>
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+
+//Own includes
+#include "graphGen/common/idDictionary.hpp"
+#include "graphGen/common/edgeRouter.hpp"
+
+//External includes
+#include "extutils/logging.hpp"
+#include "mxx/comm.hpp"
+#include "mxx/reduction.hpp"
+#include "mxx/algos.hpp"
+
+namespace conn
+{
+  namespace graphGen
+  {
+
+    /**
+     * @class     conn::graphGen::unitigCompaction
+     * @brief     Replaces every maximal non-branching path of k-mers by a single vertex
+     * @details   A k-mer is non-branching if it has at most one incoming and one outgoing
+     *            neighbor. Adjacent non-branching k-mers are chained, and every chain (path or
+     *            cycle) is labeled with the smallest k-mer id in it, using pointer doubling over
+     *            the chain links, i.e. O(log(length)) rounds of all2all.
+     *            Branching k-mers keep their own id. The edges between different labels are
+     *            emitted, which preserves the connected components. A chain without any
+     *            branching neighbor is emitted as a self loop, so that it remains a vertex.
+     *            K-mers are added on the rank that holds them in the index, chain state is
+     *            kept on the hash owner (vertexToHashOwner) of every k-mer.
+     */
+    template <typename E>
+      class unitigCompaction
+      {
+        private:
+
+          //Flags of a k-mer
+          static const uint8_t NON_BRANCHING = 1;
+          static const uint8_t SELF_LOOP = 2;
+
+          //Chain state of a k-mer, kept on its hash owner
+          struct chainNode
+          {
+            E id;
+            uint8_t flags;
+
+            //Non-branching neighbors, id itself for an empty slot
+            E chain[2];
+
+            //Link jumped to along the chain from each slot, <v, v> once the chain end is reached
+            std::pair<E,E> succ[2];
+
+            //Smallest id seen along the chain from each slot
+            E minId[2];
+
+            //Smallest id of the whole chain
+            E label;
+
+            //True if the chain has a branching neighbor
+            bool external;
+          };
+
+          //K-mers added on this rank, with their distinct neighbors (self excluded)
+          std::vector<E> kmerIds;
+          std::vector<uint8_t> kmerFlags;
+          std::vector<std::size_t> neighborOffsets;
+          std::vector<E> neighbors;
+
+          //Chain state of the k-mers owned by this rank, sorted by id
+          std::vector<chainNode> owned;
+
+          vertexToHashOwner<E> vertexRankAssigner;
+
+          const mxx::comm &comm;
+
+        public:
+
+          /**
+           * @brief                 constructor
+           * @param[in] comm        mpi communicator
+           */
+          unitigCompaction(const mxx::comm &_comm) : neighborOffsets(1, 0), vertexRankAssigner(_comm.size()), comm(_comm)
+          {
+          }
+
+          /**
+           * @brief                   adds a k-mer, every k-mer should be added on exactly one rank
+           * @param[in] id            vertex id of the k-mer
+           * @param[in] adjacent      vertex ids of its in and out neighbors, may repeat or contain id
+           * @param[in] nonBranching  true if the k-mer has at most one in and one out neighbor
+           */
+          void addKmer(E id, std::vector<E> &adjacent, bool nonBranching)
+          {
+            std::sort(adjacent.begin(), adjacent.end());
+            adjacent.erase(std::unique(adjacent.begin(), adjacent.end()), adjacent.end());
+
+            uint8_t flags = 0;
+
+            auto self = std::lower_bound(adjacent.begin(), adjacent.end(), id);
+            if(self != adjacent.end() && *self == id)
+            {
+              adjacent.erase(self);
+              flags |= SELF_LOOP;
+            }
+
+            //At most two distinct neighbors, so that the chains are paths or cycles
+            if(nonBranching && adjacent.size() <= 2)
+              flags |= NON_BRANCHING;
+
+            kmerIds.push_back(id);
+            kmerFlags.push_back(flags);
+            neighbors.insert(neighbors.end(), adjacent.begin(), adjacent.end());
+            neighborOffsets.push_back(neighbors.size());
+          }
+
+          /**
+           * @brief                 labels the chains and sends the unitig level edges
+           * @param[in] router      router of the edge list, finish() is left to the caller
+           * @details               Collective, the added k-mers are released
+           */
+          void populateEdgeList(edgeRouter<E> &router)
+          {
+            publishKmers();
+
+            //Flags of the neighbors, aligned with the neighbors vector
+            std::vector<uint8_t> neighborFlags = query<E, uint8_t>(neighbors, [&](const E &v) -> uint8_t {
+                auto node = find(v);
+                return node ? node->flags : 0;
+                });
+
+            linkChains(neighborFlags);
+
+            std::size_t rounds = jumpChains();
+
+            for(auto &node : owned)
+            {
+              node.label = node.id;
+
+              if(node.flags & NON_BRANCHING)
+                for(int i = 0; i < 2; i++)
+                  if(node.chain[i] != node.id)
+                    node.label = std::min(node.label, node.minId[i]);
+            }
+
+            //Labels of the local non-branching k-mers and of their non-branching neighbors
+            std::vector<E> labelKeys;
+            for(std::size_t i = 0; i < kmerIds.size(); i++)
+            {
+              if(kmerFlags[i] & NON_BRANCHING)
+                labelKeys.push_back(kmerIds[i]);
+
+              for(std::size_t j = neighborOffsets[i]; j < neighborOffsets[i+1]; j++)
+                if(neighborFlags[j] & NON_BRANCHING)
+                  labelKeys.push_back(neighbors[j]);
+            }
+
+            std::vector<E> labels = query<E, E>(labelKeys, [&](const E &v) {
+                return find(v)->label;
+                });
+
+            //Labels of chains with a branching neighbor
+            std::vector<E> externalLabels;
+
+            auto nextLabel = labels.begin();
+            for(std::size_t i = 0; i < kmerIds.size(); i++)
+            {
+              bool nonBranching = kmerFlags[i] & NON_BRANCHING;
+              E u = nonBranching ? *nextLabel++ : kmerIds[i];
+
+              for(std::size_t j = neighborOffsets[i]; j < neighborOffsets[i+1]; j++)
+              {
+                if(neighborFlags[j] & NON_BRANCHING)
+                  nextLabel++;
+                else if(nonBranching)
+                  externalLabels.push_back(u);
+              }
+            }
+
+            for(auto &v : sendToOwners(externalLabels))
+              find(v)->external = true;
+
+            //Vertices left after the compaction
+            std::size_t vertexCount = 0;
+            for(auto &node : owned)
+              if(node.label == node.id)
+                vertexCount++;
+
+            std::size_t kmerCount = mxx::allreduce(owned.size(), comm);
+            vertexCount = mxx::allreduce(vertexCount, comm);
+
+            LOG_IF(!comm.rank(), INFO) << "Unitig compaction : " << kmerCount << " k-mers -> " << vertexCount
+              << " vertices, " << rounds << " pointer doubling rounds";
+
+            //Edges are routed after the last collective call, see edgeRouter
+            nextLabel = labels.begin();
+            for(std::size_t i = 0; i < kmerIds.size(); i++)
+            {
+              bool nonBranching = kmerFlags[i] & NON_BRANCHING;
+              E u = nonBranching ? *nextLabel++ : kmerIds[i];
+
+              for(std::size_t j = neighborOffsets[i]; j < neighborOffsets[i+1]; j++)
+              {
+                E v = (neighborFlags[j] & NON_BRANCHING) ? *nextLabel++ : neighbors[j];
+
+                //Edges within a chain disappear
+                if(u != v)
+                  router.push(u, v);
+              }
+            }
+
+            //Isolated chains become self loops
+            for(auto &node : owned)
+            {
+              bool chained = node.chain[0] != node.id || node.chain[1] != node.id;
+
+              if(node.label == node.id && (node.flags & NON_BRANCHING) && !node.external && (chained || (node.flags & SELF_LOOP)))
+                router.push(node.id, node.id);
+            }
+
+            std::vector<E>().swap(kmerIds);
+            std::vector<uint8_t>().swap(kmerFlags);
+            std::vector<std::size_t>(1, 0).swap(neighborOffsets);
+            std::vector<E>().swap(neighbors);
+            std::vector<chainNode>().swap(owned);
+          }
+
+        private:
+
+          /**
+           * @brief     sends the added k-mers and their flags to their hash owners
+           */
+          void publishKmers()
+          {
+            std::vector< std::pair<E, uint8_t> > records(kmerIds.size());
+            for(std::size_t i = 0; i < kmerIds.size(); i++)
+              records[i] = std::make_pair(kmerIds[i], kmerFlags[i]);
+
+            std::vector<std::size_t> sendCounts = mxx::bucketing(records, [&](const std::pair<E, uint8_t> &r){
+                return vertexRankAssigner(r.first);
+                }, comm.size());
+
+            records = mxx::all2allv(records, sendCounts, comm);
+
+            owned.resize(records.size());
+            for(std::size_t i = 0; i < records.size(); i++)
+            {
+              owned[i].id = records[i].first;
+              owned[i].flags = records[i].second;
+              owned[i].chain[0] = owned[i].chain[1] = owned[i].label = records[i].first;
+              owned[i].external = false;
+            }
+
+            std::sort(owned.begin(), owned.end(), [](const chainNode &a, const chainNode &b){
+                return a.id < b.id;
+                });
+          }
+
+          /**
+           * @brief                 links every non-branching k-mer to its non-branching neighbors,
+           *                        and initializes the first jump of every link
+           */
+          void linkChains(const std::vector<uint8_t> &neighborFlags)
+          {
+            //<k-mer, <chain neighbor 1, chain neighbor 2>>
+            std::vector< std::pair<E, std::pair<E,E> > > links;
+
+            for(std::size_t i = 0; i < kmerIds.size(); i++)
+            {
+              if(!(kmerFlags[i] & NON_BRANCHING))
+                continue;
+
+              E chain[2] = {kmerIds[i], kmerIds[i]};
+              int slot = 0;
+
+              for(std::size_t j = neighborOffsets[i]; j < neighborOffsets[i+1]; j++)
+                if(neighborFlags[j] & NON_BRANCHING)
+                  chain[slot++] = neighbors[j];
+
+              if(slot > 0)
+                links.emplace_back(kmerIds[i], std::make_pair(chain[0], chain[1]));
+            }
+
+            for(auto &l : sendToOwners(links))
+            {
+              auto node = find(l.first);
+              node->chain[0] = l.second.first;
+              node->chain[1] = l.second.second;
+            }
+
+            //Link <u, v> first jumps to <v, w>, w being the other chain neighbor of v
+            std::vector< std::pair<E,E> > reverseLinks;
+            for(auto &node : owned)
+              for(int i = 0; i < 2; i++)
+                if(node.chain[i] != node.id)
+                  reverseLinks.emplace_back(node.chain[i], node.id);
+
+            std::vector<E> next = query< std::pair<E,E>, E >(reverseLinks, [&](const std::pair<E,E> &l) {
+                auto node = find(l.first);
+                return node->chain[0] != l.second ? node->chain[0] : node->chain[1];
+                });
+
+            auto w = next.begin();
+            for(auto &node : owned)
+              for(int i = 0; i < 2; i++)
+                if(node.chain[i] != node.id)
+                {
+                  E v = node.chain[i];
+                  node.succ[i] = std::make_pair(v, *w++);
+                  node.minId[i] = v;
+                }
+          }
+
+          /**
+           * @brief     pointer doubling over the chain links, till every link reaches the end of its
+           *            chain, or covers the longest possible cycle
+           * @return    count of rounds
+           */
+          std::size_t jumpChains()
+          {
+            std::size_t nonBranchingCount = 0;
+            for(auto &node : owned)
+              if(node.flags & NON_BRANCHING)
+                nonBranchingCount++;
+
+            nonBranchingCount = mxx::allreduce(nonBranchingCount, comm);
+
+            std::size_t rounds = 0;
+
+            //Links jump over 2^rounds k-mers, a cycle is covered once that reaches its length
+            for(; (1UL << rounds) < nonBranchingCount; rounds++)
+            {
+              std::vector< std::pair<E,E> > jumps;
+              for(auto &node : owned)
+                for(int i = 0; i < 2; i++)
+                  if(node.chain[i] != node.id && active(node.succ[i]))
+                    jumps.push_back(node.succ[i]);
+
+              if(mxx::allreduce(jumps.size(), comm) == 0)
+                break;
+
+              //<succ, minId> of the link jumped to
+              auto responses = query< std::pair<E,E>, std::pair< std::pair<E,E>, E > >(jumps, [&](const std::pair<E,E> &l) {
+                  auto node = find(l.first);
+                  int i = node->chain[0] == l.second ? 0 : 1;
+                  return std::make_pair(node->succ[i], node->minId[i]);
+                  });
+
+              auto r = responses.begin();
+              for(auto &node : owned)
+                for(int i = 0; i < 2; i++)
+                  if(node.chain[i] != node.id && active(node.succ[i]))
+                  {
+                    node.minId[i] = std::min(node.minId[i], r->second);
+                    node.succ[i] = r->first;
+                    r++;
+                  }
+            }
+
+            return rounds;
+          }
+
+          /**
+           * @brief     true if the link has not reached the end of its chain
+           */
+          static bool active(const std::pair<E,E> &link)
+          {
+            return link.first != link.second;
+          }
+
+          /**
+           * @brief     chain state of an owned k-mer, nullptr if the k-mer was never added
+           */
+          chainNode* find(const E &id)
+          {
+            auto it = std::lower_bound(owned.begin(), owned.end(), id, [](const chainNode &a, const E &b){
+                return a.id < b;
+                });
+
+            return (it != owned.end() && it->id == id) ? &(*it) : nullptr;
+          }
+
+          static E keyVertex(const E &key)
+          {
+            return key;
+          }
+
+          template <typename T>
+            static E keyVertex(const std::pair<E,T> &key)
+            {
+              return key.first;
+            }
+
+          /**
+           * @brief     sends the records to the hash owner of their key vertex
+           * @return    records received by this rank
+           */
+          template <typename T>
+            std::vector<T> sendToOwners(std::vector<T> &records)
+            {
+              std::vector<std::size_t> sendCounts = mxx::bucketing(records, [&](const T &r){
+                  return vertexRankAssigner(keyVertex(r));
+                  }, comm.size());
+
+              return mxx::all2allv(records, sendCounts, comm);
+            }
+
+          /**
+           * @brief                 answers the keys on the hash owners of their key vertex
+           * @return                answers, in the same order as keys
+           * @details               Single request/response all2all, answer should not change
+           *                        the owned state
+           */
+          template <typename Q, typename R, typename Answer>
+            std::vector<R> query(const std::vector<Q> &keys, Answer answer)
+            {
+              //<key, index in keys>
+              std::vector< std::pair<Q, std::size_t> > queries(keys.size());
+              for(std::size_t i = 0; i < keys.size(); i++)
+                queries[i] = std::make_pair(keys[i], i);
+
+              std::vector<std::size_t> sendCounts = mxx::bucketing(queries, [&](const std::pair<Q, std::size_t> &q){
+                  return vertexRankAssigner(keyVertex(q.first));
+                  }, comm.size());
+
+              std::vector<std::size_t> recvCounts = mxx::all2all(sendCounts, comm);
+
+              std::vector<Q> queryKeys(queries.size());
+              std::transform(queries.begin(), queries.end(), queryKeys.begin(), [](const std::pair<Q, std::size_t> &q){ return q.first; });
+
+              auto receivedKeys = mxx::all2allv(queryKeys, sendCounts, comm);
+
+              std::vector<R> answers(receivedKeys.size());
+              for(std::size_t i = 0; i < receivedKeys.size(); i++)
+                answers[i] = answer(receivedKeys[i]);
+
+              auto responses = mxx::all2allv(answers, recvCounts, comm);
+
+              std::vector<R> result(keys.size());
+              for(std::size_t i = 0; i < queries.size(); i++)
+                result[queries[i].second] = responses[i];
+
+              return result;
+            }
+      };
+
+  }
+}
+
+#endif
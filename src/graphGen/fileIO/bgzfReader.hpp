@@ -0,0 +1,257 @@
+/*
+ * Copyright 2016 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    bgzfReader.hpp
+ * @ingroup graphGen
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ * @brief   Parallel decompression of BGZF (blocked gzip, as written by bgzip) text files
+ * @details Each rank decompresses only the blocks that begin in its share of the compressed
+ *          file, and the partial records at the rank boundaries are handed to the left neighbour.
+ *          Requires zlib, i.e. CONN_HAVE_ZLIB.
+ *
+ * Copyright (c) 2016 Georgia Institute of Technology. All Rights Reserved.
+ */
+
+#ifndef GRAPH_BGZF_READER_HPP
+#define GRAPH_BGZF_READER_HPP
+
+//Includes
+#include <mpi.h>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#ifdef CONN_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+//External includes
+#include "mxx/comm.hpp"
+#include "mxx/collective.hpp"
+#include "mxx/shift.hpp"
+
+namespace conn
+{
+  namespace graphGen
+  {
+    namespace bgzf
+    {
+      //Fixed part of the block header, including the 'BC' extra subfield
+      const std::size_t HEADER_SIZE = 18;
+
+      //Upper bound on the compressed and uncompressed size of a block
+      const std::size_t MAX_BLOCK_SIZE = 1UL << 16;
+
+      inline uint16_t readLE16(const unsigned char *p)
+      {
+        return p[0] | (p[1] << 8);
+      }
+
+      inline uint32_t readLE32(const unsigned char *p)
+      {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+      }
+
+      /**
+       * @brief             size of the block starting at p, 0 if p is not a block header
+       */
+      inline std::size_t blockSize(const unsigned char *p, std::size_t available)
+      {
+        if(available < HEADER_SIZE)
+          return 0;
+
+        //gzip magic, deflate, FEXTRA flag, XLEN = 6, 'BC' subfield with SLEN = 2
+        if(p[0] != 31 || p[1] != 139 || p[2] != 8 || p[3] != 4 || readLE16(p + 10) != 6 ||
+            p[12] != 'B' || p[13] != 'C' || readLE16(p + 14) != 2)
+          return 0;
+
+        return readLE16(p + 16) + 1;
+      }
+
+      /**
+       * @brief             true if the file begins with a BGZF block
+       */
+      inline bool isBgzfFile(const std::string &fileName)
+      {
+        std::ifstream in(fileName, std::ios::in | std::ios::binary);
+
+        unsigned char header[HEADER_SIZE];
+        in.read(reinterpret_cast<char*>(header), HEADER_SIZE);
+
+        return in.gcount() == static_cast<std::streamsize>(HEADER_SIZE) && blockSize(header, HEADER_SIZE) > 0;
+      }
+
+#ifdef CONN_HAVE_ZLIB
+      /**
+       * @brief             appends the uncompressed contents of a block to out
+       */
+      inline bool inflateBlock(const unsigned char *block, std::size_t size, std::vector<char> &out)
+      {
+        //Payload excludes the header and the CRC32 + ISIZE trailer
+        std::size_t payload = size - HEADER_SIZE - 8;
+        uint32_t uncompressedSize = readLE32(block + size - 4);
+
+        std::size_t initialSize = out.size();
+        out.resize(initialSize + uncompressedSize);
+
+        if(uncompressedSize == 0)
+          return true;
+
+        z_stream zs = {};
+        if(inflateInit2(&zs, -15) != Z_OK)
+          return false;
+
+        zs.next_in = const_cast<unsigned char*>(block + HEADER_SIZE);
+        zs.avail_in = payload;
+        zs.next_out = reinterpret_cast<unsigned char*>(out.data() + initialSize);
+        zs.avail_out = uncompressedSize;
+
+        int status = inflate(&zs, Z_FINISH);
+        inflateEnd(&zs);
+
+        return status == Z_STREAM_END;
+      }
+#endif
+
+      /**
+       * @brief             decompresses the blocks that begin in this rank's share of the file
+       * @return            uncompressed text of this rank, beginning and ending at a line boundary
+       * @details           1. The compressed file is split evenly, each rank scans for the first block
+       *                       header in its share, confirmed by a second header right after it
+       *                    2. Blocks that begin in the share are decompressed
+       *                    3. Every rank except the first moves the characters before its first
+       *                       end of line to the previous rank, same as find_first_record
+       * @note              Each rank's text should contain at least one end of line, i.e. a line
+       *                    may not span more than a rank's share of the file. Aborts otherwise.
+       * @note              Only line based text, i.e. edge lists, is handled. FASTQ records span
+       *                    four lines and need a different boundary rule, and the de Bruijn graph
+       *                    path reads through the bliss loaders, which memory map the file. 
+       *                    Compressed sequences should be decompressed first.
+       */
+      inline std::vector<char> readPartition(const std::string &fileName, const mxx::comm &comm)
+      {
+        std::vector<char> text;
+
+#ifdef CONN_HAVE_ZLIB
+        MPI_File fh;
+        if(MPI_File_open(comm, const_cast<char*>(fileName.c_str()), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+        {
+          if(!comm.rank()) std::cerr << "Unable to open file " << fileName << std::endl;
+          MPI_Abort(comm, 1);
+        }
+
+        MPI_Offset fileSize;
+        MPI_File_get_size(fh, &fileSize);
+
+        std::size_t p = comm.size(), rank = comm.rank();
+        std::size_t shareBegin = fileSize * rank / p;
+        std::size_t shareEnd = fileSize * (rank + 1) / p;
+
+        //Blocks beginning before shareEnd may extend two full blocks beyond it (one more for validation)
+        std::size_t readEnd = std::min<std::size_t>(fileSize, shareEnd + 2 * MAX_BLOCK_SIZE);
+
+        std::vector<unsigned char> compressed(readEnd - shareBegin);
+
+        //Read in chunks, MPI counts are int
+        for(std::size_t done = 0; done < compressed.size();)
+        {
+          std::size_t chunk = std::min<std::size_t>(1UL << 30, compressed.size() - done);
+
+          MPI_File_read_at(fh, static_cast<MPI_Offset>(shareBegin + done), compressed.data() + done,
+              static_cast<int>(chunk), MPI_BYTE, MPI_STATUS_IGNORE);
+
+          done += chunk;
+        }
+
+        MPI_File_close(&fh);
+
+        const unsigned char *buffer = compressed.data();
+        std::size_t length = compressed.size();
+        std::size_t localShare = shareEnd - shareBegin;
+
+        //Find the first block header in the share
+        std::size_t pos = 0;
+        for(; pos < localShare; pos++)
+        {
+          std::size_t size = blockSize(buffer + pos, length - pos);
+
+          //Accept if followed by another header, or by the end of file
+          if(size > 0 && pos + size <= length &&
+              (shareBegin + pos + size == static_cast<std::size_t>(fileSize) || blockSize(buffer + pos + size, length - pos - size) > 0))
+            break;
+        }
+
+        //Decompress the blocks beginning in the share
+        while(pos < localShare)
+        {
+          std::size_t size = blockSize(buffer + pos, length - pos);
+
+          if(size == 0 || pos + size > length || !inflateBlock(buffer + pos, size, text))
+          {
+            std::cerr << "Corrupt BGZF block at offset " << shareBegin + pos << " in " << fileName << std::endl;
+            MPI_Abort(comm, 1);
+          }
+
+          pos += size;
+        }
+#else
+        if(!comm.rank()) std::cerr << "Reading " << fileName << " requires zlib, rebuild with zlib available" << std::endl;
+        MPI_Abort(comm, 1);
+#endif
+
+        //Hand the partial first record to the previous rank holding any text
+        comm.with_subset(text.size() > 0, [&](const mxx::comm &comm){
+
+            auto eol = text.begin();
+
+            if(comm.rank() > 0)
+            {
+              eol = std::find_if(text.begin(), text.end(), [](char c){ return c == '\n' || c == '\r'; });
+
+              //The partial record would have to travel past the previous rank
+              if(eol == text.end())
+              {
+                std::cerr << "No end of line in the text of rank " << comm.rank() << " in " << fileName 
+                  << ", a line spans more than a rank's share, use fewer ranks" << std::endl;
+                MPI_Abort(comm, 1);
+              }
+
+              //The end of line travels with the record
+              eol++;
+            }
+
+            std::vector<char> prefix(text.begin(), eol);
+            std::vector<char> suffix = mxx::left_shift(prefix, comm);
+
+            text.erase(text.begin(), eol);
+            text.insert(text.end(), suffix.begin(), suffix.end());
+
+            //Terminate the last record of the file
+            if(comm.rank() == comm.size() - 1 && !text.empty() && text.back() != '\n')
+              text.push_back('\n');
+            });
+
+        return text;
+      }
+    }
+  }
+}
+
+#endif
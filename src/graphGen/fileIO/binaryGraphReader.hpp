@@ -0,0 +1,240 @@
+/*
+ * Copyright 2016 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    binaryGraphReader.hpp
+ * @ingroup graphGen
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ * @brief   Parallel reader for the binary edge list files written by writeEdgeListBinaryFormat()
+ *
+ * Copyright (c) 2016 Georgia Institute of Technology. All Rights Reserved.
+ */
+
+#ifndef BINARY_GRAPH_READER_HPP
+#define BINARY_GRAPH_READER_HPP
+
+//Includes
+#include <mpi.h>
+#include <iostream>
+#include <cstdio>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+
+//Own includes
+#include "graphGen/common/timer.hpp"
+#include "graphGen/common/hashKernels.hpp"
+
+//External includes
+#include "extutils/logging.hpp"
+#include "mxx/comm.hpp"
+#include "mxx/collective.hpp"
+
+namespace conn
+{
+  namespace graphGen
+  {
+
+    /**
+     * @class     conn::graphGen::BinaryGraphReader
+     * @brief     Reads edge lists saved as raw <uint64_t, uint64_t> pairs
+     * @details   Input can be a single file, or a directory with the graph.<rank>.bin files.
+     *            The edges of all the files are split evenly across the ranks, independent
+     *            of the count of ranks that wrote them. Each rank reads its byte range
+     *            straight into the edge list using MPI-IO, nothing is parsed.
+     */
+    template <typename E>
+      class BinaryGraphReader
+      {
+        private:
+
+          //Bytes per edge record
+          static const std::size_t RECORD_SIZE = 2 * sizeof(uint64_t);
+
+          //Largest single read, MPI counts are int
+          static const std::size_t MAX_READ = 1UL << 30;
+
+          //MPI communicator
+          mxx::comm comm;
+
+          //Switch to determine if reverse of each edge should be included as well
+          bool addReverseEdge;
+
+          //Switch to permute the vertex ids while reading, same as calling permuteVectorIds() later
+          bool permuteIds;
+
+        public:
+
+          /**
+           * @brief                   constructor for this class
+           * @param[in] addReverseEdge  true if the file holds each edge once (as written by writeEdgeListBinaryFormat)
+           * @param[in] permuteIds    permute the vertex ids while reading
+           */
+          BinaryGraphReader(const mxx::comm &_comm, bool _addReverseEdge = true, bool _permuteIds = false)
+            : comm(_comm.copy()), addReverseEdge(_addReverseEdge), permuteIds(_permuteIds)
+          {
+            static_assert(sizeof(std::pair<E,E>) == RECORD_SIZE, "Vertex ids should be 64-bit");
+          }
+
+          /**
+           * @brief                   populates the edge list vector
+           * @param[out] edgeList     distributed edge list
+           * @param[in]  path         binary file, or directory containing graph.*.bin files
+           */
+          void populateEdgeList(std::vector< std::pair<E,E> > &edgeList, const std::string &path)
+          {
+            Timer timer;
+
+            std::vector<std::string> fileNames = listFiles(path);
+
+            //File sizes are queried by rank 0 only
+            std::vector<std::size_t> fileSizes(fileNames.size(), 0);
+
+            if(!comm.rank())
+            {
+              for(std::size_t i = 0; i < fileNames.size(); i++)
+              {
+                struct stat st;
+                if(stat(fileNames[i].c_str(), &st) == 0)
+                  fileSizes[i] = st.st_size;
+                else
+                  std::cerr << "Unable to open file " << fileNames[i] << std::endl;
+
+                if(fileSizes[i] % RECORD_SIZE)
+                  std::cerr << "Size of file " << fileNames[i] << " is not a multiple of " << RECORD_SIZE << " bytes, ignoring the trailing bytes" << std::endl;
+              }
+            }
+
+            mxx::bcast(fileSizes.data(), fileSizes.size(), 0, comm);
+
+            //Records in each file, and the global index of their first record
+            std::vector<std::size_t> fileOffsets(fileNames.size() + 1, 0);
+            for(std::size_t i = 0; i < fileNames.size(); i++)
+              fileOffsets[i+1] = fileOffsets[i] + fileSizes[i] / RECORD_SIZE;
+
+            std::size_t totalRecords = fileOffsets.back();
+
+            //Even split, first (totalRecords % p) ranks get one extra record
+            std::size_t p = comm.size(), rank = comm.rank();
+            std::size_t localBegin = rank * (totalRecords / p) + std::min(rank, totalRecords % p);
+            std::size_t localEnd = localBegin + totalRecords / p + (rank < totalRecords % p ? 1 : 0);
+            std::size_t localRecords = localEnd - localBegin;
+
+            std::size_t initialSize = edgeList.size();
+            edgeList.resize(initialSize + localRecords * (addReverseEdge ? 2 : 1));
+
+            //Records are read directly into the edge list
+            char *buffer = reinterpret_cast<char*>(edgeList.data() + initialSize);
+
+            for(std::size_t i = 0; i < fileNames.size(); i++)
+            {
+              std::size_t begin = std::max(localBegin, fileOffsets[i]);
+              std::size_t end = std::min(localEnd, fileOffsets[i+1]);
+
+              if(begin < end)
+              {
+                readRange(fileNames[i], (begin - fileOffsets[i]) * RECORD_SIZE, (end - begin) * RECORD_SIZE, buffer);
+                buffer += (end - begin) * RECORD_SIZE;
+              }
+            }
+
+            auto first = edgeList.begin() + initialSize;
+
+            if(permuteIds)
+              hash_64_batch(reinterpret_cast<uint64_t*>(&(*first)), 2 * localRecords);
+
+            //Append the reversed edges to the second half
+            if(addReverseEdge)
+              std::transform(first, first + localRecords, first + localRecords, [](const std::pair<E,E> &e){
+                  return std::make_pair(e.second, e.first);
+                  });
+
+            LOG_IF(!comm.rank(), INFO) << "Read " << totalRecords << " records from " << fileNames.size() << " binary file(s)";
+
+            timer.end_section("File IO completed, graph built");
+          }
+
+        private:
+
+          /**
+           * @brief             reads a contiguous byte range of a file
+           */
+          void readRange(const std::string &fileName, std::size_t offset, std::size_t length, char *buffer)
+          {
+            MPI_File fh;
+            if(MPI_File_open(MPI_COMM_SELF, const_cast<char*>(fileName.c_str()), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+            {
+              std::cerr << "Unable to open file " << fileName << std::endl;
+              MPI_Abort(comm, 1);
+            }
+
+            for(std::size_t done = 0; done < length;)
+            {
+              std::size_t chunk = length - done < MAX_READ ? length - done : MAX_READ;
+
+              MPI_File_read_at(fh, static_cast<MPI_Offset>(offset + done), buffer + done,
+                  static_cast<int>(chunk), MPI_BYTE, MPI_STATUS_IGNORE);
+
+              done += chunk;
+            }
+
+            MPI_File_close(&fh);
+          }
+
+          /**
+           * @brief             files to read, sorted by the rank that wrote them
+           * @details           a directory is expanded to the graph.<rank>.bin files in it
+           */
+          static std::vector<std::string> listFiles(const std::string &path)
+          {
+            struct stat st;
+            if(stat(path.c_str(), &st) != 0 || !S_ISDIR(st.st_mode))
+              return std::vector<std::string>(1, path);
+
+            //<rank that wrote the file, file name>
+            std::vector< std::pair<long, std::string> > files;
+
+            if(DIR *dir = opendir(path.c_str()))
+            {
+              while(struct dirent *entry = readdir(dir))
+              {
+                std::string name = entry->d_name;
+                long writerRank;
+                char suffix[8];
+
+                if(std::sscanf(name.c_str(), "graph.%ld.%7s", &writerRank, suffix) == 2 && std::string(suffix) == "bin")
+                  files.emplace_back(writerRank, path + "/" + name);
+              }
+
+              closedir(dir);
+            }
+
+            std::sort(files.begin(), files.end());
+
+            std::vector<std::string> fileNames;
+            for(auto &f : files)
+              fileNames.push_back(f.second);
+
+            return fileNames;
+          }
+      };
+
+  }
+}
+
+#endif
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2016 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    edgeListFormat.hpp
+ * @ingroup graphGen
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ * @brief   Layout of the text edge list files accepted by GraphFileParser
+ *
+ * Copyright (c) 2016 Georgia Institute of Technology. All Rights Reserved.
+ */
+
+#ifndef GRAPH_EDGE_LIST_FORMAT_HPP
+#define GRAPH_EDGE_LIST_FORMAT_HPP
+
+//Includes
+#include <string>
+#include <sstream>
+#include <limits>
+
+namespace conn
+{
+  namespace graphGen
+  {
+    /**
+     * @brief     Columns and comments of a text edge list
+     * @details   Columns are separated by spaces or tabs, and counted from 0. Columns
+     *            other than the selected ones are ignored. Default layout accepts plain
+     *            edge lists as well as SNAP files (tab separated, '#' comments)
+     */
+    struct edgeListFormat
+    {
+      //Lines beginning with any of these characters are skipped
+      std::string commentChars = "%#";
+
+      //Columns holding the two vertex ids
+      int srcColumn = 0;
+      int destColumn = 1;
+
+      //Column holding the edge weight, negative if the edges are not weighted
+      int weightColumn = -1;
+
+      //Edges with weight below this value are dropped while parsing
+      double minWeight = -std::numeric_limits<double>::infinity();
+
+      //Matrix Market files have a "rows columns entries" line after the comments
+      bool sizeHeader = false;
+
+      /**
+       * @brief     Matrix Market coordinate format, pattern or weighted
+       */
+      static edgeListFormat matrixMarket()
+      {
+        edgeListFormat format;
+        format.commentChars = "%";
+        format.sizeHeader = true;
+        return format;
+      }
+
+      /**
+       * @brief     layout guessed from the file extension, .mtx is Matrix Market
+       */
+      static edgeListFormat fromFileName(const std::string &fileName)
+      {
+        const std::string mtx = ".mtx";
+
+        if(fileName.size() >= mtx.size() && fileName.compare(fileName.size() - mtx.size(), mtx.size(), mtx) == 0)
+          return matrixMarket();
+
+        return edgeListFormat();
+      }
+
+      /**
+       * @brief     largest column index that needs to be parsed
+       */
+      int lastColumn() const
+      {
+        return std::max(std::max(srcColumn, destColumn), weightColumn);
+      }
+
+      std::string toString() const
+      {
+        std::stringstream ss;
+        ss << "columns (src " << srcColumn << ", dest " << destColumn;
+        if(weightColumn >= 0)
+          ss << ", weight " << weightColumn << " >= " << minWeight;
+        ss << ")" << (sizeHeader ? ", with size header" : "");
+        return ss.str();
+      }
+    };
+  }
+}
+
+#endif
@@ -0,0 +1,253 @@
+/*
+ * Copyright 2016 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    fastParse.hpp
+ * @ingroup graphGen
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ * @brief   Allocation free parsing of numbers directly over the file buffer
+ * @details Functions advance the iterator along with the byte offset, same as
+ *          the bliss file parser helpers (findEOL, findNonEOL)
+ *
+ * Copyright (c) 2016 Georgia Institute of Technology. All Rights Reserved.
+ */
+
+#ifndef GRAPH_FAST_PARSE_HPP
+#define GRAPH_FAST_PARSE_HPP
+
+//Includes
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <cmath>
+
+namespace conn
+{
+  namespace graphGen
+  {
+    namespace fastParse
+    {
+      inline bool isDigit(char c)
+      {
+        return static_cast<unsigned char>(c - '0') < 10;
+      }
+
+      inline bool isBlank(char c)
+      {
+        return c == ' ' || c == '\t';
+      }
+
+      inline bool isEOL(char c)
+      {
+        return c == '\n' || c == '\r';
+      }
+
+      /**
+       * @brief             parses 8 ASCII digits at once using SWAR arithmetic
+       * @return            false if any of the 8 characters is not a digit
+       */
+      inline bool parseEightDigits(const char *p, uint64_t &value)
+      {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        uint64_t chunk;
+        std::memcpy(&chunk, p, sizeof(chunk));
+
+        //Every byte should be in ['0', '9'], i.e. 0x30 to 0x39
+        if( ((chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) != 0x3333333333333333ULL)
+          return false;
+
+        chunk -= 0x3030303030303030ULL;
+
+        //Combine the digits pairwise, then into 4 digit and 8 digit values
+        chunk = (chunk * 10) + (chunk >> 8);
+        chunk = (((chunk & 0x000000FF000000FFULL) * 0x000F424000000064ULL) +
+            (((chunk >> 16) & 0x000000FF000000FFULL) * 0x0000271000000001ULL)) >> 32;
+
+        value = value * 100000000ULL + chunk;
+        return true;
+#else
+        return false;
+#endif
+      }
+
+      /**
+       * @brief             accumulates the digits at the iterator position into value
+       */
+      template <typename Iter>
+        inline void accumulateDigits(Iter &curr, const Iter &end, std::size_t &offset, uint64_t &value)
+        {
+          while(curr != end && isDigit(*curr))
+          {
+            value = value * 10 + (*curr - '0');
+            curr++; offset++;
+          }
+        }
+
+      /**
+       * @brief             same as above, for contiguous buffers; consumes 8 digits per step
+       *                    while enough bytes are left in the buffer
+       */
+      template <typename CharT>
+        inline void accumulateDigits(CharT* &curr, CharT* const &end, std::size_t &offset, uint64_t &value)
+        {
+          static_assert(sizeof(CharT) == 1, "Expecting a byte buffer");
+
+          while(end - curr >= 8 && parseEightDigits(reinterpret_cast<const char*>(curr), value))
+          {
+            curr += 8; offset += 8;
+          }
+
+          while(curr != end && isDigit(*curr))
+          {
+            value = value * 10 + (*curr - '0');
+            curr++; offset++;
+          }
+        }
+
+      /**
+       * @brief             parses an optionally signed decimal integer
+       * @return            false if no digit is found at the iterator position
+       */
+      template <typename Iter, typename T>
+        inline bool parseInteger(Iter &curr, const Iter &end, std::size_t &offset, T &value)
+        {
+          bool negative = false;
+
+          if(curr != end && *curr == '-' && std::is_signed<T>::value)
+          {
+            negative = true;
+            curr++; offset++;
+          }
+
+          if(curr == end || !isDigit(*curr))
+            return false;
+
+          uint64_t magnitude = 0;
+          accumulateDigits(curr, end, offset, magnitude);
+
+          value = negative ? static_cast<T>(0 - magnitude) : static_cast<T>(magnitude);
+          return true;
+        }
+
+      /**
+       * @brief             parses a decimal number with optional sign, fraction and exponent
+       * @return            false if no digit is found at the iterator position
+       * @note              result may differ from strtod() in the last bits, good enough
+       *                    for comparing weights against a threshold
+       */
+      template <typename Iter>
+        inline bool parseDecimal(Iter &curr, const Iter &end, std::size_t &offset, double &value)
+        {
+          bool negative = false;
+
+          if(curr != end && (*curr == '-' || *curr == '+'))
+          {
+            negative = *curr == '-';
+            curr++; offset++;
+          }
+
+          uint64_t mantissa = 0;
+          int exponent = 0;
+          bool digitFound = false;
+
+          for(; curr != end && isDigit(*curr); curr++, offset++)
+          {
+            digitFound = true;
+            if(mantissa < (1ULL << 59)) mantissa = mantissa * 10 + (*curr - '0'); else exponent++;
+          }
+
+          if(curr != end && *curr == '.')
+          {
+            curr++; offset++;
+
+            for(; curr != end && isDigit(*curr); curr++, offset++)
+            {
+              digitFound = true;
+              if(mantissa < (1ULL << 59)) { mantissa = mantissa * 10 + (*curr - '0'); exponent--; }
+            }
+          }
+
+          if(!digitFound)
+            return false;
+
+          if(curr != end && (*curr == 'e' || *curr == 'E'))
+          {
+            curr++; offset++;
+
+            if(curr != end && *curr == '+')
+            {
+              curr++; offset++;
+            }
+
+            int e;
+            if(!parseInteger(curr, end, offset, e))
+              return false;
+
+            exponent += e;
+          }
+
+          value = static_cast<double>(mantissa) * std::pow(10.0, exponent);
+          if(negative) value = -value;
+
+          return true;
+        }
+
+      /**
+       * @brief             skips the characters up to the next blank or end of line
+       */
+      template <typename Iter>
+        inline void skipToken(Iter &curr, const Iter &end, std::size_t &offset)
+        {
+          while(curr != end && !isBlank(*curr) && !isEOL(*curr))
+          {
+            curr++; offset++;
+          }
+        }
+
+      /**
+       * @brief             skips the characters up to the end of line
+       */
+      template <typename Iter>
+        inline void skipLine(Iter &curr, const Iter &end, std::size_t &offset)
+        {
+          while(curr != end && !isEOL(*curr))
+          {
+            curr++; offset++;
+          }
+        }
+
+      /**
+       * @brief             skips spaces and tabs
+       * @return            count of characters skipped
+       */
+      template <typename Iter>
+        inline std::size_t skipBlanks(Iter &curr, const Iter &end, std::size_t &offset)
+        {
+          std::size_t count = 0;
+
+          while(curr != end && isBlank(*curr))
+          {
+            curr++; offset++; count++;
+          }
+
+          return count;
+        }
+    }
+  }
+}
+
+#endif
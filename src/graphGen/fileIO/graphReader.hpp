@@ -28,11 +28,24 @@
 
 //Includes
 #include <iostream>
+#include <future>
+#include <numeric>
+#include <memory>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 //Own includes
 #include "graphGen/common/timer.hpp"
+#include "graphGen/common/hashKernels.hpp"
+#include "graphGen/fileIO/fastParse.hpp"
+#include "graphGen/fileIO/bgzfReader.hpp"
+#include "graphGen/fileIO/edgeListFormat.hpp"
+#include "graphGen/fileIO/inputFiles.hpp"
+#include "graphGen/common/edgeRouter.hpp"
 
 //External includes
+#include "extutils/logging.hpp"
 #include "io/file_loader.hpp"
 #include "common/base_types.hpp"
 #include "mxx/comm.hpp"
@@ -114,6 +127,21 @@ namespace conn
         //Switch to determine if reverse of each edge should be included as well
         bool addReverseEdge;
 
+        //Switch to permute the vertex ids while parsing, same as calling permuteVectorIds() later
+        bool permuteIds;
+
+        //Columns, comments and header of the input
+        edgeListFormat format;
+
+        //True until the size header is consumed, if the format has one
+        bool headerPending;
+
+        //Switch to send the edges to the owner of their source vertex while parsing
+        bool routeToOwner;
+
+        //Active while parsing, if routeToOwner is set
+        std::unique_ptr< edgeRouter<E> > router;
+
         //Reference to the distributed edge list 
         std::vector< std::pair<E,E> > &edgeList;
 
@@ -127,15 +155,27 @@ namespace conn
          * @brief                 constructor for this class
          * @param[in] edgeList    Edgelist to build
          * @param[in] comm        mpi communicator
+         * @param[in] permuteIds  permute the vertex ids while parsing
+         * @param[in] format      columns and comments of the input, edges filtered by the
+         *                        format (e.g. weight threshold) are never inserted
+         * @param[in] routeToOwner  send each edge to the hash owner of its source vertex
+         *                        while parsing, see edgeRouter
          */
         template <typename vID>
           GraphFileParser(std::vector< std::pair<vID, vID> > &edgeList, bool addReverseEdge,
-              std::string &filename, const mxx::comm &comm) 
+              std::string &filename, const mxx::comm &comm, bool permuteIds = false,
+              const edgeListFormat &format = edgeListFormat(), bool routeToOwner = false) 
           : edgeList(edgeList), 
           addReverseEdge(addReverseEdge),
+          permuteIds(permuteIds),
+          format(format),
+          routeToOwner(routeToOwner),
           filename(filename),
           comm(comm.copy())
         {
+          //Header follows the comments at the beginning of the file, i.e. on the first rank
+          headerPending = format.sizeHeader && !this->comm.rank();
+
           static_assert(std::is_same<E, vID>::value, "Edge vector type should match");
         }
 
@@ -145,15 +185,39 @@ namespace conn
          */
         void populateEdgeList()
         {
+          std::vector<std::string> files = listInputFiles(filename, comm);
+
+          //Lists, directories and patterns are read through the chunked reader
+          if(files.size() != 1)
+          {
+            parseFilesChunked(files);
+            return;
+          }
+
+          //Single file, possibly given as a directory or a pattern
+          const std::string &fileName = files[0];
+
           Timer timer;
 
+          beginRouting();
+
+          //Block compressed input is decompressed in parallel, and parsed from memory
+          if(bgzf::isBgzfFile(fileName))
+          {
+            parseBgzfFile(fileName);
+            finishRouting();
+
+            timer.end_section("File IO completed (BGZF), graph built");
+            return;
+          }
+
           //Value type over which Iterator is defined
           typedef typename std::iterator_traits<Iterator>::value_type IteratorValueType;
 
           //Define file loader type
           typedef bliss::io::FileLoader<IteratorValueType, OVERLAP, GraphFileLoader > FileLoaderType;
 
-          FileLoaderType loader(filename, comm);
+          FileLoaderType loader(fileName, comm);
 
           //====  now process the file, one L1 block partition per MPI Rank 
           typename FileLoaderType::L1BlockType partition = loader.getNextL1Block();
@@ -182,15 +246,248 @@ namespace conn
             lastEdgeRead = readAnEdge(dataIter, partition.end(), i, localFileRange.end);
           }
 
+          finishRouting();
+
+          timer.end_section("File IO completed, graph built");
+        }
+
+        /**
+         * @brief                   populates the edge list vector, reading the files in chunks
+         * @param[in] chunkSize     bytes per read, reader memory is about two chunks
+         * @details                 The input may name several files (see listInputFiles()). Plain files
+         *                          are split by size across the ranks as if they were concatenated, so
+         *                          a rank may read parts of several small files or a part of a large one.
+         *                          Each rank walks its share of a file in chunks, parsing a chunk
+         *                          while the next one is read by a separate thread. A record belongs
+         *                          to the rank whose share contains its first character, the partial
+         *                          record at the end of a chunk is carried over to the next one.
+         *                          Block compressed files are read one after the other by all the ranks.
+         */
+        void populateEdgeListChunked(std::size_t chunkSize = 1UL << 26)
+        {
+          parseFilesChunked(listInputFiles(filename, comm), chunkSize);
+        }
+
+      private:
+
+        /**
+         * @brief                   populateEdgeListChunked() over the expanded list of files
+         */
+        void parseFilesChunked(const std::vector<std::string> &files, std::size_t chunkSize = 1UL << 26)
+        {
+          Timer timer;
+
+          std::vector<std::string> plainFiles;
+
+          //Each block compressed file is decompressed collectively, so its edges are
+          //routed before the next file is read
+          for(auto &f : files)
+          {
+            if(bgzf::isBgzfFile(f))
+            {
+              beginRouting();
+              parseBgzfFile(f);
+              finishRouting();
+            }
+            else
+              plainFiles.push_back(f);
+          }
+
+          std::vector<std::size_t> fileSizes = getFileSizes(plainFiles, comm);
+
+          beginRouting();
+          std::size_t totalSize = std::accumulate(fileSizes.begin(), fileSizes.end(), 0UL);
+
+          //Share of this rank in the concatenation of the files
+          std::size_t p = comm.size(), rank = comm.rank();
+          std::size_t globalBegin = totalSize * rank / p;
+          std::size_t globalEnd = totalSize * (rank + 1) / p;
+
+          for(std::size_t i = 0, fileStart = 0; i < plainFiles.size(); fileStart += fileSizes[i], i++)
+          {
+            std::size_t shareBegin = std::max(globalBegin, fileStart);
+            std::size_t shareEnd = std::min(globalEnd, fileStart + fileSizes[i]);
+
+            if(shareBegin < shareEnd)
+              parseFileShare(plainFiles[i], fileSizes[i], shareBegin - fileStart, shareEnd - fileStart, chunkSize);
+          }
+
+          finishRouting();
+
+          LOG_IF(!comm.rank(), INFO) << "Read " << totalSize << " bytes from " << plainFiles.size() << " file(s)";
+
           timer.end_section("File IO completed, graph built");
         }
 
+        void beginRouting()
+        {
+          if(routeToOwner)
+            router.reset(new edgeRouter<E>(edgeList, comm));
+        }
+
+        /**
+         * @brief                   waits for the edges from all the ranks, collective
+         */
+        void finishRouting()
+        {
+          if(router)
+          {
+            router->finish();
+            router.reset();
+          }
+        }
+
+        /**
+         * @brief                   parses the records beginning in [shareBegin, shareEnd) of a file
+         */
+        void parseFileShare(const std::string &fileName, std::size_t fileSize,
+            std::size_t shareBegin, std::size_t shareEnd, std::size_t chunkSize)
+        {
+          int fd = open(fileName.c_str(), O_RDONLY);
+          if(fd < 0)
+          {
+            std::cerr << "Unable to open file " << fileName << std::endl;
+            MPI_Abort(comm, 1);
+          }
+
+          //Header follows the comments at the beginning of each file
+          headerPending = format.sizeHeader && shareBegin == 0;
+
+          //Past the share, only the last record needs to be completed
+          const std::size_t tailChunkSize = 1UL << 16;
+
+          //Reads [from, from + length) of the file, appended to buffer
+          auto readInto = [fd](std::vector<char> &buffer, std::size_t from, std::size_t length)
+          {
+            buffer.clear();
+            buffer.resize(length);
+
+            for(std::size_t done = 0; done < length;)
+            {
+              ssize_t n = pread(fd, buffer.data() + done, length - done, from + done);
+              if(n <= 0) { buffer.resize(done); break; }
+              done += n;
+            }
+          };
+
+          //Share not beginning at the file start is read from one character early,
+          //to know if its first character begins a record
+          std::size_t readPos = shareBegin > 0 ? shareBegin - 1 : 0;
+          bool skipPartialRecord = shareBegin > 0;
+
+          std::vector<char> current, next, carry;
+
+          //Bytes to read next, beginning at from
+          auto nextLength = [&](std::size_t from) {
+            return std::min(fileSize - from, from < shareEnd ? chunkSize : tailChunkSize);
+          };
+
+          std::size_t length = nextLength(readPos);
+          readInto(current, readPos, length);
+
+          //File offset of current[0]
+          std::size_t bufferOffset = readPos;
+          readPos += length;
+
+          bool finished = false;
+
+          while(!finished)
+          {
+            //Prefetch the next chunk
+            std::size_t length = readPos < fileSize ? nextLength(readPos) : 0;
+            std::future<void> pending = std::async(std::launch::async, readInto, std::ref(next), readPos, length);
+
+            char *curr = current.data();
+            char *end = current.data() + current.size();
+            std::size_t offset = bufferOffset;
+
+            if(skipPartialRecord)
+            {
+              fastParse::skipLine(curr, end, offset);
+              skipPartialRecord = curr == end;
+            }
+
+            //Position of the partial record at the end of this chunk
+            char *partial = end;
+
+            if(!skipPartialRecord)
+            {
+              while(true)
+              {
+                char *lineBegin = curr;
+
+                if(!readAnEdge(curr, end, offset, shareEnd))
+                {
+                  if(curr == end)
+                    partial = lineBegin;
+                  else
+                    finished = true;
+
+                  break;
+                }
+              }
+            }
+
+            pending.wait();
+
+            if(finished)
+              break;
+
+            carry.assign(partial, end);
+
+            if(length == 0)
+            {
+              //End of file, terminate the last record
+              if(!carry.empty())
+              {
+                carry.push_back('\n');
+
+                char *curr = carry.data();
+                std::size_t offset = bufferOffset + std::distance(current.data(), partial);
+                readAnEdge(curr, carry.data() + carry.size(), offset, shareEnd);
+              }
+
+              break;
+            }
+
+            //Next buffer is the carried over record followed by the new chunk
+            bufferOffset = readPos - carry.size();
+            readPos += length;
+
+            next.insert(next.begin(), carry.begin(), carry.end());
+            std::swap(current, next);
+          }
+
+          close(fd);
+        }
+
+        /**
+         * @brief                   parses this rank's part of a block compressed file
+         */
+        void parseBgzfFile(const std::string &fileName)
+        {
+          std::vector<char> text = bgzf::readPartition(fileName, comm);
+
+          headerPending = format.sizeHeader && !comm.rank();
+
+          char *dataIter = text.data();
+          char *dataEnd = text.data() + text.size();
+          std::size_t i = 0;
+
+          while(readAnEdge(dataIter, dataEnd, i, text.size()));
+        }
+
+      public:
+
         /**
          * @brief             reads an edge assuming iterator points to 
          *                    beginning of a valid record
          * @param[in] curr    current iterator position
-         * @return            true if edge is read successfully,
+         * @return            true if a line is consumed (whether or not it is an edge),
          *                    false if partition boundary is encountered 
+         * @details           Numbers are parsed in place from the file buffer, only up to the last
+         *                    column required by the format. Comments, the size header and records
+         *                    that lack the required columns are skipped
          */
         template <typename Iter>
           bool readAnEdge(Iter& curr, const Iter &end, std::size_t& offset, std::size_t offsetEndRange) 
@@ -198,59 +495,77 @@ namespace conn
             //make sure we point to non EOL value
             this->findNonEOL(curr, end, offset);
 
-            //string to save the contents of a line
-            std::string readLine;
-
             if(offset >= offsetEndRange || curr == end)
               return false;
 
-            //till we see end of line
-            while( ! (*curr == baseType::eol || *curr == baseType::cr)) 
-            {
-              //return if we are crossing the boundary
-              if(curr == end)
-                return false;
+            E vertex1, vertex2;
+            double weight = 0;
 
-              //keep pushing the character to string
-              readLine.append(curr, 1);
+            bool isComment = format.commentChars.find(*curr) != std::string::npos;
+            bool isEdge = !isComment && !headerPending;
 
-              //advance iterator
-              curr++; offset++;
+            //Columns parsed so far
+            int column = 0;
+            const int lastColumn = format.lastColumn();
 
-              //return if we are crossing the boundary
-              if(curr == end)
-                return false;
+            while(isEdge && column <= lastColumn)
+            {
+              if(column == format.srcColumn)
+                isEdge = fastParse::parseInteger(curr, end, offset, vertex1);
+              else if(column == format.destColumn)
+                isEdge = fastParse::parseInteger(curr, end, offset, vertex2);
+              else if(column == format.weightColumn)
+                isEdge = fastParse::parseDecimal(curr, end, offset, weight);
+              else
+                fastParse::skipToken(curr, end, offset);
+
+              //Columns should be separated by blanks, and the last one followed by blanks or end of line
+              if(isEdge && fastParse::skipBlanks(curr, end, offset) == 0 && (column < lastColumn || (curr != end && !fastParse::isEOL(*curr))))
+                isEdge = false;
+
+              column++;
             }
 
-            parseStringForEdge(readLine);
+            if(!isComment && headerPending)
+              headerPending = false;
+
+            //Remaining columns, or the rest of an invalid record
+            fastParse::skipLine(curr, end, offset);
+
+            //return if we are crossing the boundary
+            if(curr == end)
+              return false;
+
+            if(isEdge && (format.weightColumn < 0 || weight >= format.minWeight))
+              insertEdge(vertex1, vertex2);
 
             return true;
           }
 
         /**
-         * @brief             assumes string with two integers as input,
-         *                    parse the integers and insert to edgeList
-         * @param[in] record  string with 2 integers separated by space
-         */                    
-        inline void parseStringForEdge(std::string &record)
+         * @brief             inserts a parsed edge to edgeList
+         */
+        inline void insertEdge(E vertex1, E vertex2)
         {
-          std::stringstream stream(record);
-
-          size_t n = std::count(record.begin(), record.end(), ' ');
-
-          E vertex1, vertex2;
-
-          stream >> vertex1;
-          stream >> vertex2;
+          if(permuteIds)
+          {
+            vertex1 = permuteId(vertex1);
+            vertex2 = permuteId(vertex2);
+          }
 
-          if(n == 1)
+          if(router)
+          {
+            router->push(vertex1, vertex2);
+            if(addReverseEdge)
+              router->push(vertex2, vertex1);
+          }
+          else
           {
             edgeList.emplace_back(vertex1, vertex2);
             if(addReverseEdge)
               edgeList.emplace_back(vertex2, vertex1);
           }
         }
-
     };
   }
 }
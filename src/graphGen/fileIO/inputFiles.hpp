@@ -0,0 +1,199 @@
+/*
+ * Copyright 2016 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    inputFiles.hpp
+ * @ingroup graphGen
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ * @brief   Expansion of the input arguments (lists, directories, glob patterns) to files,
+ *          and queries over the input files
+ *
+ * Copyright (c) 2016 Georgia Institute of Technology. All Rights Reserved.
+ */
+
+#ifndef GRAPH_INPUT_FILES_HPP
+#define GRAPH_INPUT_FILES_HPP
+
+//Includes
+#include <mpi.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <dirent.h>
+#include <glob.h>
+#include <sys/stat.h>
+
+//External includes
+#include "mxx/comm.hpp"
+#include "mxx/collective.hpp"
+
+namespace conn
+{
+  namespace graphGen
+  {
+    /**
+     * @brief             prints the error on rank 0 and aborts all the ranks
+     */
+    inline void abortOnInputError(const std::string &message, const mxx::comm &comm)
+    {
+      std::cerr << message << std::endl;
+      MPI_Abort(comm, 1);
+    }
+
+    /**
+     * @brief             expands the input argument to the list of files to read
+     * @param[in] input   comma separated list of files, directories or glob patterns
+     * @return            files in the order given, directories and patterns expanded
+     *                    in sorted order, hidden files in directories are skipped
+     * @details           Expanded by rank 0 and broadcast, so that all the ranks see the same list.
+     *                    Aborts if a listed file does not exist, if a directory or a pattern
+     *                    gives no file, or if the list is empty
+     */
+    inline std::vector<std::string> listInputFiles(const std::string &input, const mxx::comm &comm)
+    {
+      std::vector<std::string> files;
+
+      //Expanded list, one file per line
+      std::string joined;
+
+      if(!comm.rank())
+      {
+        std::stringstream ss(input);
+        std::string item;
+
+        while(std::getline(ss, item, ','))
+        {
+          if(item.empty())
+            continue;
+
+          struct stat st;
+
+          if(stat(item.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+          {
+            std::vector<std::string> entries;
+
+            if(DIR *dir = opendir(item.c_str()))
+            {
+              while(struct dirent *entry = readdir(dir))
+              {
+                std::string path = item + "/" + entry->d_name;
+
+                if(entry->d_name[0] != '.' && stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode))
+                  entries.push_back(path);
+              }
+
+              closedir(dir);
+            }
+
+            if(entries.empty())
+              abortOnInputError("No input file in directory " + item, comm);
+
+            std::sort(entries.begin(), entries.end());
+            files.insert(files.end(), entries.begin(), entries.end());
+          }
+          else if(item.find_first_of("*?[") != std::string::npos)
+          {
+            glob_t matches;
+
+            if(glob(item.c_str(), 0, nullptr, &matches) != 0 || matches.gl_pathc == 0)
+              abortOnInputError("No input file matches " + item, comm);
+
+            for(std::size_t i = 0; i < matches.gl_pathc; i++)
+              files.push_back(matches.gl_pathv[i]);
+
+            globfree(&matches);
+          }
+          else if(stat(item.c_str(), &st) == 0)
+            files.push_back(item);
+          else
+            abortOnInputError("Unable to open file " + item, comm);
+        }
+
+        if(files.empty())
+          abortOnInputError("No input file given", comm);
+
+        for(auto &f : files)
+          joined += f + "\n";
+      }
+
+      std::size_t length = joined.size();
+      mxx::bcast(&length, 1, 0, comm);
+
+      joined.resize(length);
+      mxx::bcast(&joined[0], length, 0, comm);
+
+      if(comm.rank())
+      {
+        std::stringstream ss(joined);
+        std::string f;
+
+        while(std::getline(ss, f))
+          files.push_back(f);
+      }
+
+      return files;
+    }
+
+    /**
+     * @brief             sizes of the files in bytes, queried by rank 0 only, aborts if a file
+     *                    does not exist
+     */
+    inline std::vector<std::size_t> getFileSizes(const std::vector<std::string> &files, const mxx::comm &comm)
+    {
+      std::vector<std::size_t> sizes(files.size(), 0);
+
+      if(!comm.rank())
+      {
+        for(std::size_t i = 0; i < files.size(); i++)
+        {
+          struct stat st;
+          if(stat(files[i].c_str(), &st) == 0)
+            sizes[i] = st.st_size;
+          else
+            abortOnInputError("Unable to open file " + files[i], comm);
+        }
+      }
+
+      mxx::bcast(sizes.data(), sizes.size(), 0, comm);
+
+      return sizes;
+    }
+
+    /**
+     * @brief             true if the first record of a sequence file is a FASTA record ('>'),
+     *                    checked by rank 0 only
+     */
+    inline bool isFastaFile(const std::string &fileName, const mxx::comm &comm)
+    {
+      char first = 0;
+
+      if(!comm.rank())
+      {
+        std::ifstream in(fileName);
+        in >> first;
+      }
+
+      mxx::bcast(&first, 1, 0, comm);
+
+      return first == '>' || first == ';';
+    }
+  }
+}
+
+#endif
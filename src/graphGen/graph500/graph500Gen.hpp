@@ -33,6 +33,8 @@
 
 //Own includes
 #include "graphGen/common/timer.hpp"
+#include "graphGen/common/hashKernels.hpp"
+#include "graphGen/common/edgeRouter.hpp"
 
 //External includes
 #include "graph500-gen/make_graph.h"
@@ -61,6 +63,10 @@ namespace conn
          * @param[out] edgeList   input vector to fill up
          * @param[in] scale       scale of the graph
          * @param[in] edgeFactor  edgeFactor of the graph
+         * @param[in] permuteIds  permute the vertex ids while copying the edges, 
+         *                        same as calling permuteVectorIds() later
+         * @param[in] routeToOwner  send each edge to the hash owner of its source vertex,
+         *                        see edgeRouter
          * @details               Each edge generated using kronecker generator is 
          *                        replicated both side ways (u--v, v--u) in 
          *                        the edgeList
@@ -68,7 +74,9 @@ namespace conn
         void populateEdgeList( std::vector< std::pair<int64_t, int64_t> > &edgeList, 
             uint8_t scale, 
             uint8_t edgeFactor, 
-            const mxx::comm &comm)
+            const mxx::comm &comm,
+            bool permuteIds = false,
+            bool routeToOwner = false)
         {
           //seeds to use
           int64_t seeds[2] = {1,2};
@@ -84,6 +92,8 @@ namespace conn
           //Use the internal function to populate the edges
           make_graph(scale, desired_nedges, seeds[0], seeds[1], initiator, &nedges, &edges);
 
+          edgeRouter<T> router(edgeList, comm, routeToOwner);
+
           for (int i = 0; i < nedges; ++i) 
           {
             T src = edges[2*i];
@@ -91,14 +101,22 @@ namespace conn
 
             if ((src >= 0) && (dest >= 0)) 
             { 
+              if(permuteIds)
+              {
+                src = permuteId(src);
+                dest = permuteId(dest);
+              }
+
               // valid edge
-              edgeList.emplace_back(src, dest);
+              router.push(src, dest);
 
               //Insert the reverse edge if the mode is undirected
-              edgeList.emplace_back(dest, src);
+              router.push(dest, src);
             }
           }
 
+          router.finish();
+
           //Free temporary memory
           free(edges);
 
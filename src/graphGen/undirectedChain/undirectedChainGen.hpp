@@ -31,6 +31,9 @@
 #include <iostream>
 #include <vector>
 
+//Own includes
+#include "graphGen/common/edgeRouter.hpp"
+
 //External includes
 #include "mxx/timer.hpp"
 #include "mxx/partition.hpp"
@@ -52,11 +55,14 @@ namespace conn
          * @param[in] chainLength length of the graph i.e. the count of nodes (not the edges)
          *                        For example, chain of length 100 will be like 0-1-2...100
          * @param[out] edgeList   input vector to fill up
+         * @param[in] routeToOwner  send each edge to the hash owner of its source vertex,
+         *                        see edgeRouter
          */
         template <typename T>
         void populateEdgeList( std::vector< std::pair<T, T> > &edgeList, 
             uint64_t chainLength, 
-            const mxx::comm &comm = mxx::comm())
+            const mxx::comm &comm = mxx::comm(),
+            bool routeToOwner = false)
         {
           mxx::section_timer timer;
 
@@ -64,6 +70,8 @@ namespace conn
           //Lets divide the chainLength value by the number of processes
           mxx::partition::block_decomposition<T> part(chainLength, comm.size(), comm.rank());
 
+          edgeRouter<T> router(edgeList, comm, routeToOwner);
+
           {
             //First node (vertex) id on this MPI node
             T beginNodeId = part.excl_prefix_size(); 
@@ -73,19 +81,21 @@ namespace conn
             {
               for(int i = beginNodeId; i < lastNodeId; i++)
               {
-                edgeList.emplace_back(i, i + 1);
-                edgeList.emplace_back(i + 1, i);
+                router.push(i, i + 1);
+                router.push(i + 1, i);
               }
 
               //If not last rank, attach edges from last node of this rank to first node of next rank
               if(part.prefix_size() < chainLength)
               {
-                edgeList.emplace_back(lastNodeId, lastNodeId+1);
-                edgeList.emplace_back(lastNodeId+1, lastNodeId);
+                router.push(lastNodeId, lastNodeId+1);
+                router.push(lastNodeId+1, lastNodeId);
               }
             }
           }
 
+          router.finish();
+
           timer.end_section("graph generation completed");
         }
 
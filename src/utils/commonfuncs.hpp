@@ -29,6 +29,8 @@
 //Includes
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <tuple>
 
 //External includes
 #include "mxx/comm.hpp"
@@ -101,6 +103,83 @@ namespace conn
           }
       };
    
+    /**
+     * @brief           end of the run of elements equivalent to *first in a sorted range
+     * @details         Gallops ahead with doubling steps, then binary searches the last step,
+     *                  i.e. O(log(run length)) comparisons and a single comparison for runs of length 1
+     * @param[in] comp  comparator the range is sorted by
+     */
+    template<typename RandomAccessIterator, class Compare>
+      RandomAccessIterator findRunEnd(RandomAccessIterator first, RandomAccessIterator last, Compare comp)
+      {
+        if(first == last)
+          return last;
+
+        auto n = std::distance(first, last);
+
+        //first + known is the last element known to be in the run
+        decltype(n) known = 0, probe = 1, step = 1;
+
+        while(probe < n && !comp(*first, *(first + probe)))
+        {
+          known = probe;
+          step *= 2;
+          probe = known + step;
+        }
+
+        return std::upper_bound(first + known + 1, first + std::min(probe, n), *first, comp);
+      }
+
+    /**
+     * @brief           calls f(runBegin, runEnd) for every run of equal keys in a sorted range
+     * @tparam layer    Tuple's index the range is sorted by
+     */
+    template<size_t layer, typename RandomAccessIterator, typename F>
+      void forEachRun(RandomAccessIterator first, RandomAccessIterator last, F f)
+      {
+        TpleComp<layer> comp;
+
+        for(auto it = first; it != last;)
+        {
+          auto runEnd = findRunEnd(it, last, comp);
+
+          f(it, runEnd);
+
+          it = runEnd;
+        }
+      }
+
+    /**
+     * @brief               calls f(runBegin, runEnd, minElement, maxElement) for every run of equal keys
+     *                      in a sorted range, where min and max elements are reduced over valueLayer
+     * @tparam keyLayer     Tuple's index the range is sorted by
+     * @tparam valueLayer   Tuple's index used for the reductions
+     * @details             Replaces the findRange() + local_reduce() pattern, both reductions are
+     *                      computed by the same scan, while the run boundary is found by galloping
+     */
+    template<size_t keyLayer, size_t valueLayer, typename RandomAccessIterator, typename F>
+      void forEachRunMinMax(RandomAccessIterator first, RandomAccessIterator last, F f)
+      {
+        TpleComp<keyLayer> comp;
+
+        for(auto it = first; it != last;)
+        {
+          auto runEnd = findRunEnd(it, last, comp);
+
+          auto minElement = it, maxElement = it;
+
+          for(auto it2 = it + 1; it2 != runEnd; it2++)
+          {
+            if(std::get<valueLayer>(*it2) < std::get<valueLayer>(*minElement)) minElement = it2;
+            if(std::get<valueLayer>(*maxElement) < std::get<valueLayer>(*it2)) maxElement = it2;
+          }
+
+          f(it, runEnd, minElement, maxElement);
+
+          it = runEnd;
+        }
+      }
+
     /**
      * @brief           Functor for comparing tuples by two index layers
      * @tparam layer1   Tuple's primary index which is used for comparison
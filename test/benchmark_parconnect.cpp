@@ -73,9 +73,11 @@ int main(int argc, char** argv)
   cmd.defineOption("input", "dbg or kronecker or generic or chain", ArgvParser::OptionRequiresValue | ArgvParser::OptionRequired);
   cmd.defineOption("file", "input file (if input = dbg or generic)", ArgvParser::OptionRequiresValue);
   cmd.defineOption("scale", "scale of the graph (if input = kronecker)", ArgvParser::OptionRequiresValue);
-  cmd.defineOption("bfsiter", "number of BFS iterations to execute at the start, default is 1", ArgvParser::OptionRequiresValue | ArgvParser::OptionRequired);
+  cmd.defineOption("k", "kmer size, one of 21, 31, 41, 51 or 63 (if input = dbg, sequences in FASTQ or FASTA format), default is 31", ArgvParser::OptionRequiresValue);
+  cmd.defineOption("bfsiter", "number of BFS iterations to execute at the start, or 'auto' to stop once components get small", ArgvParser::OptionRequiresValue | ArgvParser::OptionRequired);
   cmd.defineOption("pointerDouble", "set to y/n to control pointer doubling during coloring", ArgvParser::OptionRequiresValue | ArgvParser::OptionRequired);
   cmd.defineOption("chainLength", "length of undirected chain graph (if input = chain)", ArgvParser::OptionRequiresValue);
+  cmd.defineOption("relabel", "sort or hash based engine to make the vertex ids contiguous before BFS, default is sort", ArgvParser::OptionRequiresValue);
 
   int result = cmd.parse(argc, argv);
 
@@ -101,6 +103,9 @@ int main(int argc, char** argv)
   //Read number of bfs iterations
   std::size_t bfsIterations = 1;  //Default
 
+  //Let the BFS phase decide its own count of iterations
+  bool bfsAdaptive = false;
+
   //Fetch the pointer doubling choice
   bool pointerDouble;
   if(cmd.optionValue("pointerDouble") == "y")
@@ -108,7 +113,10 @@ int main(int argc, char** argv)
   else
     pointerDouble = false;
 
-  bfsIterations = std::stoi(cmd.optionValue("bfsiter")); 
+  if(cmd.optionValue("bfsiter") == "auto")
+    bfsAdaptive = true;
+  else
+    bfsIterations = std::stoi(cmd.optionValue("bfsiter")); 
 
 #ifdef BENCHMARK_CONN
   mxx::section_timer timer(std::cerr, comm);
@@ -152,8 +160,13 @@ int main(int argc, char** argv)
 
     LOG_IF(!comm.rank(), INFO) << "Input file -> " << fileName;
 
+    //Kmer size
+    unsigned int k = cmd.foundOption("k") ? std::stoi(cmd.optionValue("k")) : 31;
+
+    LOG_IF(!comm.rank(), INFO) << "Kmer size -> " << k;
+
     //Object of the graph generator class
-    conn::graphGen::deBruijnGraph g;
+    conn::graphGen::deBruijnGraph g(k);
 
     //Populate the edgeList
     g.populateEdgeList(edgeList, fileName, comm); 
@@ -225,10 +238,16 @@ int main(int argc, char** argv)
   timer.end_section("Vertex Ids permuted");
 #endif
 
+  //Remembers the sort order of the edges across the relabeling and BFS phases
+  conn::graphGen::sortedAdjacency<vertexIdType> adjacency(edgeList, comm);
+
   //Call the graph reducer function
   if(bfsIterations > 0) 
   {
-    conn::graphGen::reduceVertexIds(edgeList, nVertices, comm);
+    if(cmd.foundOption("relabel") && cmd.optionValue("relabel") == "hash")
+      conn::graphGen::reduceVertexIds(edgeList, nVertices, comm, conn::graphGen::reduceIdsEngine::hashBased);
+    else
+      conn::graphGen::reduceVertexIds(adjacency, nVertices);
     LOG_IF(!comm.rank(), INFO) << "Ids compacted for BFS run";
 
 #ifdef BENCHMARK_CONN
@@ -253,10 +272,13 @@ int main(int argc, char** argv)
 
   if(bfsIterations > 0)
   {
-    conn::bfs::bfsSupport<vertexIdType> bfsInstance(edgeList, nVertices, comm);
+    conn::bfs::bfsSupport<vertexIdType> bfsInstance(adjacency, nVertices, comm);
 
-    //Run BFS once
-    noBFSIterationsExecuted = bfsInstance.runBFSIterations(bfsIterations, componentCountsResult); 
+    //Run BFS the given count of times, or till the components become small
+    if(bfsAdaptive)
+      noBFSIterationsExecuted = bfsInstance.runBFSIterationsAdaptive(componentCountsResult); 
+    else
+      noBFSIterationsExecuted = bfsInstance.runBFSIterations(bfsIterations, componentCountsResult); 
 
 #ifdef BENCHMARK_CONN
     timer.end_section("BFS iterations executed");
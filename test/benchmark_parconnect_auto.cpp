@@ -26,15 +26,20 @@
 //Includes
 #include <mpi.h>
 #include <iostream>
+#include <sstream>
+#include <memory>
 
 //Own includes
 #include "graphGen/fileIO/graphReader.hpp"
+#include "graphGen/fileIO/binaryGraphReader.hpp"
 #include "graphGen/deBruijn/deBruijnGraphGen.hpp"
 #include "graphGen/graph500/graph500Gen.hpp"
 #include "graphGen/common/reduceIds.hpp"
+#include "graphGen/common/idMapping.hpp"
 #include "coloring/labelProp.hpp"
 #include "bfs/bfsRunner.hpp"
 #include "dynamic/degreeDistInfo.hpp"
+#include "dynamic/costModel.hpp"
 
 //External includes
 #include "extutils/logging.hpp"
@@ -70,9 +75,23 @@ int main(int argc, char** argv)
   cmd.setIntroductoryDescription("Benchmark for computing connectivity of large undirected graphs");
   cmd.setHelpOption("h", "help", "Print this help page");
 
-  cmd.defineOption("input", "dbg or kronecker or generic", ArgvParser::OptionRequiresValue | ArgvParser::OptionRequired);
-  cmd.defineOption("file", "input file (if input = dbg or generic)", ArgvParser::OptionRequiresValue);
+  cmd.defineOption("input", "dbg or kronecker or generic or binary", ArgvParser::OptionRequiresValue | ArgvParser::OptionRequired);
+  cmd.defineOption("file", "input file, directory, glob pattern or comma separated list of these (if input = dbg or generic), or binary file or directory of graph.<rank>.bin files (if input = binary)", ArgvParser::OptionRequiresValue);
   cmd.defineOption("scale", "scale of the graph (if input = kronecker)", ArgvParser::OptionRequiresValue);
+  cmd.defineOption("k", "kmer size, one of 21, 31, 41, 51 or 63 (if input = dbg, sequences in FASTQ or FASTA format), default is 31", ArgvParser::OptionRequiresValue);
+  cmd.defineOption("chunk", "read the input file in chunks of this many MB, overlapping reading and parsing (if input = generic)", ArgvParser::OptionRequiresValue);
+  cmd.defineOption("columns", "zero based columns of the source, destination and optionally the weight, e.g. 0,1,2 (if input = generic), default is 0,1", ArgvParser::OptionRequiresValue);
+  cmd.defineOption("minweight", "drop the edges with weight below this value while parsing (requires weight column)", ArgvParser::OptionRequiresValue);
+  cmd.defineOption("decision", "exact or sampled degree distribution to decide on BFS, or model to use the calibrated cost model, default is exact", ArgvParser::OptionRequiresValue);
+  cmd.defineOption("telemetry", "file to append the per level BFS statistics (csv)", ArgvParser::OptionRequiresValue);
+  cmd.defineOption("permuteOnLoad", "permute the vertex ids while the graph is generated, instead of a separate pass");
+  cmd.defineOption("streaming", "generate the de Bruijn graph edges while scanning the sequences, without a k-mer index, k at most 32 (if input = dbg)");
+  cmd.defineOption("unitigs", "compact the non-branching paths of the de Bruijn graph into single vertices, needs the k-mer index (if input = dbg)");
+  cmd.defineOption("min-abundance", "drop the de Bruijn graph edges seen fewer times than this, and the k-mers left without any edge, needs the k-mer index (if input = dbg), default is 1", ArgvParser::OptionRequiresValue);
+  cmd.defineOption("route", "send the edges to the owner rank of their source vertex while the graph is generated (if input = dbg, generic or kronecker)");
+  cmd.defineOption("bfsmass", "keep running BFS while the last component holds more than this fraction of the remaining edges, default is 0.1", ArgvParser::OptionRequiresValue);
+  cmd.defineOption("labels", "file to write the <vertex, component> labels of all the vertices, in the vertex ids given by the graph generator", ArgvParser::OptionRequiresValue);
+  cmd.defineOption("relabel", "sort or hash based engine to make the vertex ids contiguous before BFS, default is the id dictionary built by BFS (sort does not keep the table needed by --labels)", ArgvParser::OptionRequiresValue);
 
   int result = cmd.parse(argc, argv);
 
@@ -83,6 +102,21 @@ int main(int argc, char** argv)
     exit(1);
   }
 
+  //Engine to make the ids contiguous before BFS, empty if BFS builds its own dictionary
+  std::string relabel = cmd.foundOption("relabel") ? cmd.optionValue("relabel") : "";
+
+  if(relabel != "" && relabel != "sort" && relabel != "hash")
+  {
+    if(!comm.rank()) std::cerr << "Invalid '--relabel " << relabel << "', expected sort or hash\n";
+    MPI_Abort(comm, 1);
+  }
+
+  if(relabel == "sort" && cmd.foundOption("labels"))
+  {
+    if(!comm.rank()) std::cerr << "'--labels' needs the original ids, use '--relabel hash' or no '--relabel'\n";
+    MPI_Abort(comm, 1);
+  }
+
   /**
    * GENERATE GRAPH
    */
@@ -93,6 +127,20 @@ int main(int argc, char** argv)
 
   std::size_t nVertices;
 
+  //Policy to decide the count of BFS runs
+  conn::bfs::bfsContinuationPolicy bfsPolicy;
+  if(cmd.foundOption("bfsmass"))
+    bfsPolicy.minComponentMassFraction = std::stod(cmd.optionValue("bfsmass"));
+
+  //Vertex ids are permuted by the graph generators
+  bool permuteOnLoad = cmd.foundOption("permuteOnLoad");
+
+  //Edges are hash partitioned by the graph generators
+  bool routeToOwner = cmd.foundOption("route");
+
+  //Streaming de Bruijn graph construction routes the edges as well
+  bool dbgStreaming = cmd.optionValue("input") == "dbg" && cmd.foundOption("streaming");
+
   LOG_IF(!comm.rank(), INFO) << "Generating graph";
 
 #ifdef BENCHMARK_CONN
@@ -117,11 +165,79 @@ int main(int argc, char** argv)
     //Add reverse of the edges
     bool addReverse = true;
 
+    //Layout of the file, Matrix Market is recognized by .mtx extension
+    auto format = conn::graphGen::edgeListFormat::fromFileName(fileName);
+
+    if(cmd.foundOption("columns"))
+    {
+      std::stringstream columns(cmd.optionValue("columns"));
+      char comma = ',', comma2 = ',';
+      int weightColumn = -1;
+
+      bool valid = static_cast<bool>(columns >> format.srcColumn >> comma >> format.destColumn);
+
+      //Optional weight column
+      if(valid && !(columns >> std::ws).eof())
+        valid = columns >> comma2 >> weightColumn && (columns >> std::ws).eof();
+
+      valid = valid && comma == ',' && comma2 == ','
+        && format.srcColumn >= 0 && format.destColumn >= 0 && format.srcColumn != format.destColumn
+        && weightColumn != format.srcColumn && weightColumn != format.destColumn;
+
+      if(!valid)
+      {
+        if(!comm.rank()) std::cerr << "Invalid '--columns " << cmd.optionValue("columns") << "', expected distinct zero based columns src,dest[,weight]\n";
+        MPI_Abort(comm, 1);
+      }
+
+      if(weightColumn >= 0)
+        format.weightColumn = weightColumn;
+    }
+
+    if(cmd.foundOption("minweight"))
+    {
+      if(format.weightColumn < 0)
+      {
+        if(!comm.rank()) std::cerr << "'--minweight' requires a weight column, set it with '--columns src,dest,weight'\n";
+        MPI_Abort(comm, 1);
+      }
+
+      format.minWeight = std::stod(cmd.optionValue("minweight"));
+    }
+
+    LOG_IF(!comm.rank(), INFO) << "Input format -> " << format.toString();
+
     //Object of the graph generator class
-    conn::graphGen::GraphFileParser<char *, vertexIdType> g(edgeList, addReverse, fileName, comm);
+    conn::graphGen::GraphFileParser<char *, vertexIdType> g(edgeList, addReverse, fileName, comm, permuteOnLoad, format, routeToOwner);
+
+    //Populate the edgeList
+    if(cmd.foundOption("chunk"))
+      g.populateEdgeListChunked(std::stoul(cmd.optionValue("chunk")) << 20);
+    else
+      g.populateEdgeList();
+  }
+  else if(cmd.optionValue("input") == "binary")
+  {
+    //Input file or directory
+    std::string fileName;
+    if(cmd.foundOption("file"))
+      fileName = cmd.optionValue("file");
+    else
+    {
+      std::cout << "Required option missing: '--file'\n";
+      exit(1);
+    }
+
+    LOG_IF(!comm.rank(), INFO) << "Input file -> " << fileName;
+
+    //Binary files hold each edge once
+    bool addReverse = true;
+
+    //Object of the binary reader class
+    conn::graphGen::BinaryGraphReader<vertexIdType> g(comm, addReverse, permuteOnLoad);
 
     //Populate the edgeList
-    g.populateEdgeList();
+    g.populateEdgeList(edgeList, fileName);
   }
   else if(cmd.optionValue("input") == "dbg")
   {
@@ -137,11 +253,21 @@ int main(int argc, char** argv)
 
     LOG_IF(!comm.rank(), INFO) << "Input file -> " << fileName;
 
+    //Kmer size
+    unsigned int k = cmd.foundOption("k") ? std::stoi(cmd.optionValue("k")) : 31;
+
+    LOG_IF(!comm.rank(), INFO) << "Kmer size -> " << k;
+
+    //Minimum count of the edges
+    unsigned int minAbundance = cmd.foundOption("min-abundance") ? std::stoi(cmd.optionValue("min-abundance")) : 1;
+
+    LOG_IF(!comm.rank() && minAbundance > 1, INFO) << "Minimum abundance -> " << minAbundance;
+
     //Object of the graph generator class
-    conn::graphGen::deBruijnGraph g;
+    conn::graphGen::deBruijnGraph g(k, dbgStreaming, cmd.foundOption("unitigs"), minAbundance);
 
     //Populate the edgeList
-    g.populateEdgeList(edgeList, fileName, comm); 
+    g.populateEdgeList(edgeList, fileName, comm, permuteOnLoad, routeToOwner); 
   }
   else if(cmd.optionValue("input") == "kronecker")
   {
@@ -162,7 +288,7 @@ int main(int argc, char** argv)
     conn::graphGen::Graph500Gen g;
 
     //Populate the edgeList
-    g.populateEdgeList(edgeList, scale, edgefactor, comm); 
+    g.populateEdgeList(edgeList, scale, edgefactor, comm, permuteOnLoad, routeToOwner); 
   }
   else
   {
@@ -178,65 +304,122 @@ int main(int argc, char** argv)
    * COMPUTE CONNECTIVITY
    */
 
+  bool useCostModel = cmd.foundOption("decision") && cmd.optionValue("decision") == "model";
+
+  //Machine throughput for the cost model, measured outside the benchmark timer
+  conn::dynamic::machineCalibration calibration;
+  if(useCostModel)
+    calibration = conn::dynamic::calibrateMachine(comm);
+
   comm.barrier();
   auto start = std::chrono::steady_clock::now();
 
   LOG_IF(!comm.rank(), INFO) << "Beginning computation, benchmark timer started";
 
   //Relable the ids
-  conn::graphGen::permuteVectorIds(edgeList);
-  LOG_IF(!comm.rank(), INFO) << "Vertex ids permuted";
+  if(!permuteOnLoad)
+  {
+    conn::graphGen::permuteVectorIds(edgeList);
+    LOG_IF(!comm.rank(), INFO) << "Vertex ids permuted";
+  }
 
 #ifdef BENCHMARK_CONN
   timer.end_section("Vertex Ids permuted");
 #endif
 
-  bool runBFS = conn::dynamic::runBFSDecision(edgeList, comm);
+  //Remembers the sort order of the edges across the decision and BFS phases
+  conn::graphGen::sortedAdjacency<vertexIdType> adjacency(edgeList, comm, (routeToOwner && cmd.optionValue("input") != "binary") || dbgStreaming);
 
-#ifdef BENCHMARK_CONN
-    timer.end_section("Graph fit stastistics calculated");
-#endif
+  //Degree distribution computation method
+  auto degreeDistMode = conn::dynamic::degreeDistMode::exact;
+  if(cmd.foundOption("decision") && cmd.optionValue("decision") == "sampled")
+    degreeDistMode = conn::dynamic::degreeDistMode::sampled;
 
-  //Call the graph reducer function
-  //Index the vertex ids from 0 to |V|-1
-  if(runBFS) 
+  bool runBFS;
+  conn::dynamic::planPrediction prediction;
+
+  if(useCostModel)
   {
-    conn::graphGen::reduceVertexIds(edgeList, nVertices, comm);
-    LOG_IF(!comm.rank(), INFO) << "Ids compacted for BFS run";
+    prediction = conn::dynamic::choosePlan(adjacency, comm, calibration);
+    runBFS = prediction.plan == conn::dynamic::bfsThenColoring;
+  }
+  else
+    runBFS = conn::dynamic::runBFSDecision(adjacency, comm, degreeDistMode);
 
 #ifdef BENCHMARK_CONN
-    timer.end_section("Vertex Ids relabeled (contiguous)");
+    timer.end_section("Graph fit stastistics calculated");
 #endif
-  }
-
 
   //Count of edges in the graph
   std::size_t nEdges = conn::graphGen::globalSizeOfVector(edgeList, comm);
 
-  if(runBFS) 
-    LOG_IF(!comm.rank(), INFO) << "Graph size : vertices -> " << nVertices << ", edges -> " << nEdges/2  << " (x2)";
-
-  if(!runBFS)
-    LOG_IF(!comm.rank(), INFO) << "Graph size : edges -> " << nEdges/2 << " (x2)";
+  LOG_IF(!comm.rank(), INFO) << "Graph size : edges -> " << nEdges/2 << " (x2)";
 
   //For saving the size of component discovered using BFS
   std::vector<std::size_t> componentCountsResult;
 
   std::size_t noBFSIterationsExecuted = 0;
 
+  //<vertex, component label> pairs computed by BFS and coloring
+  std::vector< std::pair<vertexIdType, vertexIdType> > labels;
+
+  //Original ids of the contiguous ids, if made contiguous by the hash based engine
+  std::unique_ptr< conn::graphGen::idMapping<vertexIdType> > mapping;
+
   if(runBFS)
   {
-    conn::bfs::bfsSupport<vertexIdType> bfsInstance(edgeList, nVertices, comm);
+    if(relabel == "hash")
+    {
+      std::vector<vertexIdType> uniqueVertexList;
+      conn::graphGen::reduceVertexIds(edgeList, uniqueVertexList, comm);
+      mapping.reset(new conn::graphGen::idMapping<vertexIdType>(std::move(uniqueVertexList), comm));
 
-    //Run BFS once
-    noBFSIterationsExecuted = bfsInstance.runBFSIterations(1, componentCountsResult); 
+      //Ids changed in place, their order is lost
+      adjacency.markModified();
+    }
+    else if(relabel == "sort")
+      conn::graphGen::reduceVertexIds(adjacency, nVertices);
+
+#ifdef BENCHMARK_CONN
+    if(relabel != "")
+      timer.end_section("Vertex Ids relabeled (contiguous)");
+#endif
+
+    //Without relabeling, BFS works directly over the permuted ids, contiguous ids come from a distributed dictionary
+    std::unique_ptr< conn::bfs::bfsSupport<vertexIdType> > bfsSupportPtr(relabel == "" ?
+        new conn::bfs::bfsSupport<vertexIdType>(adjacency, comm) :
+        new conn::bfs::bfsSupport<vertexIdType>(adjacency, mapping ? mapping->size() : nVertices, comm));
+
+    auto &bfsInstance = *bfsSupportPtr;
+
+    nVertices = bfsInstance.getVertexCount();
+    LOG_IF(!comm.rank(), INFO) << "Graph size : vertices -> " << nVertices;
+
+#ifdef BENCHMARK_CONN
+    timer.end_section("BFS adjacency matrix built");
+#endif
+
+    if(cmd.foundOption("telemetry"))
+      bfsInstance.enableLevelStats();
+
+    if(cmd.foundOption("labels"))
+      bfsInstance.enableVertexLabels();
+
+    //Run BFS till the discovered components become small
+    noBFSIterationsExecuted = bfsInstance.runBFSIterationsAdaptive(componentCountsResult, bfsPolicy); 
 
 #ifdef BENCHMARK_CONN
     timer.end_section("BFS iterations executed");
 #endif
 
+    if(cmd.foundOption("telemetry"))
+      bfsInstance.writeLevelStats(cmd.optionValue("telemetry"));
+
     LOG_IF(!comm.rank(), INFO) << "Number of vertices visited by 1st BFS iteration -> " << componentCountsResult[0];
 
+    if(cmd.foundOption("labels"))
+      labels = bfsInstance.getVertexLabels();
+
     //Get the remaining edgeList
     bfsInstance.filterEdgeList();
 
@@ -258,6 +441,13 @@ int main(int argc, char** argv)
       cclInstance.compute();
 
       countComponents += cclInstance.computeComponentCount();
+
+      //Coloring covers the vertices left over by BFS
+      if(cmd.foundOption("labels"))
+      {
+        auto coloringLabels = cclInstance.getVertexLabels();
+        labels.insert(labels.end(), coloringLabels.begin(), coloringLabels.end());
+      }
       });
 
 #ifdef BENCHMARK_CONN
@@ -273,6 +463,21 @@ int main(int argc, char** argv)
 
   LOG_IF(!comm.rank(), INFO) << "Time excluding graph construction (ms) -> " << elapsed_time;
 
+  if(useCostModel)
+    LOG_IF(!comm.rank(), INFO) << "Cost model : plan -> " << (runBFS ? "BFS + coloring" : "coloring") 
+      << ", predicted time (ms) -> " << prediction.predictedTime() << ", actual time (ms) -> " << elapsed_time;
+
+  //Ids were permuted either by the generator or by permuteVectorIds(), and possibly made contiguous
+  if(cmd.foundOption("labels"))
+  {
+    conn::graphGen::translateLabels<vertexIdType>(labels, mapping.get(), true);
+
+    std::string labelsFile = cmd.optionValue("labels");
+    conn::utils::writeEdgesToFile(labels, labelsFile, comm);
+
+    LOG_IF(!comm.rank(), INFO) << "Labels written to " << labelsFile;
+  }
+
   MPI_Finalize();
   return(0);
 }
@@ -25,6 +25,8 @@
 
 //Includes
 #include <mpi.h>
+#include <fstream>
+#include <cstdio>
 
 //Own includes
 #include "bfs/bfsRunner.hpp"
@@ -198,3 +200,221 @@ TEST(bfsRunCheck, multipleUndirectedChainsMultipleRunsOneAtTime) {
     ASSERT_EQ(leftEdgesCount, 0);
   }
 }
+
+/**
+ * @brief     Rank 0 builds a long chain of 1000 vertices, and each rank 
+ *            adds 20 short chains of 5 vertices. Adaptive BFS should 
+ *            stop as soon as it runs into a short chain
+ */
+TEST(bfsRunCheck, adaptiveRunsStopOnSmallComponents) {
+
+  mxx::comm comm = mxx::comm();
+
+  //Type to use for vertices
+  using vertexIdType = int64_t;
+
+  //Distributed edge list
+  std::vector< std::pair<vertexIdType, vertexIdType> > edgeList;
+
+  //Long chain [0---999]
+  if(comm.rank() == 0)
+  {
+    for(int i = 0; i < 999; i ++)
+    {
+      edgeList.emplace_back(i, i+1);
+      edgeList.emplace_back(i+1, i);
+    }
+  }
+
+  //Short chains [1000+100*rank ... ], 5 vertices each
+  std::size_t offset = 1000 + 100*comm.rank();
+
+  for(int j = 0; j < 20; j++)
+  {
+    for(int i = 0; i < 4; i ++)
+    {
+      edgeList.emplace_back(i    +offset + 5*j, i+1  +offset + 5*j);
+      edgeList.emplace_back(i+1  +offset + 5*j, i    +offset + 5*j);
+    }
+  }
+
+  //Count of vertices
+  std::size_t nVertices = 1000 + 100*comm.size();
+
+  {
+    conn::bfs::bfsSupport<vertexIdType> bfsInstance(edgeList, nVertices, comm);
+    std::vector<std::size_t> componentCountsResult;
+
+    //Second BFS finds a component with 8 edges, far below 10% of the remaining ones
+    conn::bfs::bfsContinuationPolicy policy;
+    policy.minComponentMassFraction = 0.1;
+
+    auto iterations = bfsInstance.runBFSIterationsAdaptive(componentCountsResult, policy); 
+
+    ASSERT_EQ(iterations, 2);
+    ASSERT_EQ(componentCountsResult.size(), 2);
+    ASSERT_EQ(componentCountsResult[0], 1000);
+    ASSERT_EQ(componentCountsResult[1], 5);
+
+    bfsInstance.filterEdgeList();
+
+    //One short chain is gone along with the long chain
+    auto leftEdgesCount = conn::graphGen::globalSizeOfVector(edgeList, comm);
+    ASSERT_EQ(leftEdgesCount, 160*comm.size() - 8);
+  }
+}
+
+/**
+ * @brief     Each rank initializes a chain graph of length 50 over sparse
+ *            vertex ids, and we run BFS over that p times without relabeling
+ *            the ids first, filtering the edges after every run
+ */
+TEST(bfsRunCheck, sparseIdsMultipleRuns) {
+
+  mxx::comm comm = mxx::comm();
+
+  //Type to use for vertices
+  using vertexIdType = int64_t;
+
+  //Distributed edge list
+  std::vector< std::pair<vertexIdType, vertexIdType> > edgeList;
+
+  std::size_t offset = 50*comm.rank();
+
+  //Each rank builds undirected chain of length 50 with ids spaced apart
+  //[7---49007], [50007---99007] and so on
+  for(int i = 0; i < 49; i ++)
+  {
+    edgeList.emplace_back((i    +offset)*1000 + 7, (i+1  +offset)*1000 + 7);
+    edgeList.emplace_back((i+1  +offset)*1000 + 7, (i    +offset)*1000 + 7);
+  }
+
+  {
+    conn::bfs::bfsSupport<vertexIdType> bfsInstance(edgeList, comm);
+    std::vector<std::size_t> componentCountsResult;
+
+    //Vertex count is learnt from the edges
+    ASSERT_EQ(bfsInstance.getVertexCount(), 50*comm.size());
+
+    //Run 1 iteration p times, each one should cover one of the chains,
+    //and filter the edges after every run
+    for(int i = 0; i < comm.size(); i++)
+    {
+      bfsInstance.runBFSIterations(1, componentCountsResult); 
+      ASSERT_EQ(componentCountsResult.size(), i + 1);
+      ASSERT_EQ(componentCountsResult[i], 50);
+
+      //Remove the edges associated with the visited components
+      bfsInstance.filterEdgeList();
+
+      //Remaining edges still use the original ids
+      auto leftEdgesCount = conn::graphGen::globalSizeOfVector(edgeList, comm);
+      ASSERT_EQ(leftEdgesCount, 98*(comm.size() - 1 - i));
+
+      for(auto &e : edgeList)
+        ASSERT_EQ(e.first % 1000, 7);
+    }
+  }
+}
+
+/**
+ * @brief     Each rank initializes a chain graph of length 50, and we run
+ *            BFS over that p times with the per level statistics recorded
+ */
+TEST(bfsRunCheck, levelStatsOfChains) {
+
+  mxx::comm comm = mxx::comm();
+
+  //Type to use for vertices
+  using vertexIdType = int64_t;
+
+  //Distributed edge list
+  std::vector< std::pair<vertexIdType, vertexIdType> > edgeList;
+
+  std::size_t offset = 50*comm.rank();
+
+  //Each rank builds undirected chain of length 50
+  //[0---49], [50---99] and so on
+  for(int i = 0; i < 49; i ++)
+  {
+    edgeList.emplace_back(i    +offset, i+1  +offset);
+    edgeList.emplace_back(i+1  +offset, i    +offset);
+  }
+
+  //Count of vertices
+  std::size_t nVertices = 50*comm.size();
+
+  {
+    conn::bfs::bfsSupport<vertexIdType> bfsInstance(edgeList, nVertices, comm);
+    std::vector<std::size_t> componentCountsResult;
+
+    bfsInstance.enableLevelStats();
+    bfsInstance.runBFSIterations(comm.size(), componentCountsResult); 
+
+    auto &levelStats = bfsInstance.getLevelStats();
+
+    for(int run = 0, begin = 0; run < comm.size(); run++)
+    {
+      int end = begin;
+      while(end < levelStats.size() && levelStats[end].bfsRun == run)
+        end++;
+
+      //Source at position s of a chain needs max(s, 49-s) levels, plus a last level finding nothing
+      int levels = end - begin;
+      ASSERT_GE(levels, 26);
+      ASSERT_LE(levels, 50);
+
+      std::size_t frontierTotal = 0, edgesTotal = 0;
+
+      for(int i = begin; i < end; i++)
+      {
+        ASSERT_EQ(levelStats[i].level, i - begin);
+        ASSERT_LE(levelStats[i].frontierSize, 2);
+
+        //Frontier of the next level is the set of vertices discovered at this level
+        if(i + 1 < end)
+          ASSERT_EQ(levelStats[i+1].frontierSize, levelStats[i].discoveredSize);
+
+        frontierTotal += levelStats[i].frontierSize;
+        edgesTotal += levelStats[i].edgesExamined;
+      }
+
+      ASSERT_EQ(levelStats[begin].frontierSize, 1);
+      ASSERT_EQ(levelStats[end-1].discoveredSize, 0);
+
+      //Every vertex of the chain is expanded once, along with its edges
+      ASSERT_EQ(frontierTotal, 50);
+      ASSERT_EQ(edgesTotal, 98);
+
+      begin = end;
+    }
+
+    //Appending twice keeps a single header
+    std::string fileName = "levelStats.test.csv";
+
+    if(!comm.rank())
+      std::remove(fileName.c_str());
+
+    bfsInstance.writeLevelStats(fileName);
+    bfsInstance.writeLevelStats(fileName);
+
+    if(!comm.rank())
+    {
+      std::ifstream in(fileName);
+      std::string line;
+      std::size_t lineCount = 0, headerCount = 0;
+
+      while(std::getline(in, line))
+      {
+        lineCount++;
+        if(line.compare(0, 7, "bfs_run") == 0)
+          headerCount++;
+      }
+
+      ASSERT_EQ(headerCount, 1);
+      ASSERT_EQ(lineCount, 2 * levelStats.size() + 1);
+
+      std::remove(fileName.c_str());
+    }
+  }
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2016 Georgia Institute of Technology
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file    test_costModel.cpp
+ * @ingroup
+ * @author  Chirag Jain <cjain7@gatech.edu>
+ * @brief   GTest Unit Tests of the cost model used to pick the connectivity plan
+ *
+ * Copyright (c) 2016 Georgia Institute of Technology. All Rights Reserved.
+ */
+
+#include <mpi.h>
+
+//Own includes
+#include "dynamic/costModel.hpp"
+
+//External includes
+#include "mxx/comm.hpp"
+#include "gtest.h"
+
+INITIALIZE_EASYLOGGINGPP
+
+/**
+ * @brief       giant component of random graphs with known degree distributions
+ * @details     With half the vertices of degree 1 and half of degree 3, u = 1/4 + 3u^2/4
+ *              has the smallest root 1/3, so 8/9 of the edges are in the giant component.
+ *              Degree 1 alone gives isolated edges, degree 3 alone a single component
+ */
+TEST(costModel, giantComponentEdgeFraction) {
+
+  std::vector<std::pair<std::size_t, double>> mixed = {{1, 500}, {3, 500}};
+  ASSERT_NEAR(conn::dynamic::giantComponentEdgeFraction(mixed), 8.0/9, 1e-6);
+
+  std::vector<std::pair<std::size_t, double>> matching = {{1, 1000}};
+  ASSERT_NEAR(conn::dynamic::giantComponentEdgeFraction(matching), 0.0, 1e-6);
+
+  std::vector<std::pair<std::size_t, double>> cubic = {{3, 1000}};
+  ASSERT_NEAR(conn::dynamic::giantComponentEdgeFraction(cubic), 1.0, 1e-6);
+
+  std::vector<std::pair<std::size_t, double>> empty;
+  ASSERT_EQ(conn::dynamic::giantComponentEdgeFraction(empty), 0.0);
+}
+
+/**
+ * @brief       plan choice over a synthetic calibration, BFS should be chosen when
+ *              a giant component holds the edges, and coloring alone when there is none
+ */
+TEST(costModel, planChoice) {
+
+  conn::dynamic::machineCalibration calibration;
+  calibration.sortNsPerWord = 1.0;
+  calibration.all2allNsPerWord = 1.0;
+
+  const double p = 16;
+
+  //One million vertices of degree 3, edges counted both ways
+  std::vector<std::pair<std::size_t, double>> cubic = {{3, 1e6}};
+  auto prediction = conn::dynamic::predictPlan(cubic, 3e6, p, calibration);
+
+  ASSERT_EQ(prediction.plan, conn::dynamic::bfsThenColoring);
+  ASSERT_LT(prediction.bfsThenColoringTime, prediction.coloringOnlyTime);
+  ASSERT_EQ(prediction.predictedTime(), prediction.bfsThenColoringTime);
+
+  //Same count of edges as isolated edges, BFS only adds its overhead
+  std::vector<std::pair<std::size_t, double>> matching = {{1, 3e6}};
+  prediction = conn::dynamic::predictPlan(matching, 3e6, p, calibration);
+
+  ASSERT_EQ(prediction.plan, conn::dynamic::coloringOnly);
+  ASSERT_GT(prediction.bfsThenColoringTime, prediction.coloringOnlyTime);
+
+  //Predicted times scale with the calibrated throughput
+  calibration.sortNsPerWord = 2.0;
+  auto slowerSort = conn::dynamic::predictPlan(matching, 3e6, p, calibration);
+
+  ASSERT_NEAR(slowerSort.coloringOnlyTime, 2 * prediction.coloringOnlyTime, 1e-9);
+}
@@ -25,12 +25,27 @@
 
 #include <mpi.h>
 #include <algorithm>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <random>
+#include <map>
+#include <set>
+#include <sys/stat.h>
+#include <unistd.h>
 
 //Own includes
 #include "utils/commonfuncs.hpp"
 #include "graphGen/common/reduceIds.hpp"
+#include "graphGen/common/idMapping.hpp"
+#include "graphGen/common/hashKernels.hpp"
 #include "graphGen/graph500/graph500Gen.hpp"
 #include "graphGen/fileIO/graphReader.hpp"
+#include "graphGen/fileIO/binaryGraphReader.hpp"
+#include "graphGen/common/binaryEdgeListExport.hpp"
+#include "graphGen/deBruijn/kmerEdgeStream.hpp"
+#include "graphGen/deBruijn/deBruijnGraphGen.hpp"
+#include "graphGen/deBruijn/unitigCompaction.hpp"
 
 //External includes
 #include "extutils/logging.hpp"
@@ -105,3 +120,1062 @@ TEST(graphGen, graphFileIO) {
 
   }
 }
+
+/*
+ * @brief   Test the vertex id reduction over edges that were already sorted
+ *          for the degree distribution, i.e. by (DEST, SRC)
+ *          Graph is an undirected chain with sparse ids {3-13-23...}, relabeled ids
+ *          should form the chain {0-1-2...} and edges should be left sorted by SRC
+ */
+TEST(graphGen, reduceIdsSortedAdjacency) {
+
+  mxx::comm comm = mxx::comm();
+
+  using vertexIdType = int64_t;
+
+  const int SRC = 0, DEST = 1;
+
+  std::vector< std::pair<vertexIdType, vertexIdType> > edgeList;
+
+  //Each rank contributes 100 edges of the chain
+  for(vertexIdType i = comm.rank() * 100; i < (comm.rank() + 1) * 100; i++)
+  {
+    edgeList.emplace_back(i*10 + 3, (i+1)*10 + 3);
+    edgeList.emplace_back((i+1)*10 + 3, i*10 + 3);
+  }
+
+  conn::graphGen::sortedAdjacency<vertexIdType> adjacency(edgeList, comm);
+  adjacency.sortBy<DEST, SRC>();
+
+  std::size_t nVertices;
+  conn::graphGen::reduceVertexIds(adjacency, nVertices);
+
+  ASSERT_EQ(nVertices, comm.size() * 100 + 1);
+  ASSERT_EQ(adjacency.getPrimaryLayer(), SRC);
+  ASSERT_TRUE(mxx::is_sorted(edgeList.begin(), edgeList.end(), conn::utils::TpleComp<SRC>(), comm));
+
+  //Gather complete edgeList on rank 0
+  auto fullEdgeList = mxx::gatherv(edgeList, 0, comm);
+
+  if(!comm.rank())
+  {
+    std::sort(fullEdgeList.begin(), fullEdgeList.end(), conn::utils::TpleComp2Layers<SRC, DEST>());
+
+    ASSERT_EQ(fullEdgeList.size(), comm.size() * 200);
+
+    for(auto &e : fullEdgeList)
+      ASSERT_EQ(std::abs(e.first - e.second), 1);
+
+    ASSERT_EQ(fullEdgeList.front(), std::make_pair<vertexIdType, vertexIdType>(0, 1));
+    ASSERT_EQ(fullEdgeList.back().first, comm.size() * 100);
+  }
+}
+
+/*
+ * @brief   Test the hash based vertex id reduction and its mapping table
+ *          Graph is an undirected chain with sparse ids {3-13-23...}
+ *          New ids should be contiguous, and the mapping table should give back
+ *          the original id of every new id
+ */
+TEST(graphGen, reduceIdsHashMappingTable) {
+
+  mxx::comm comm = mxx::comm();
+
+  using vertexIdType = int64_t;
+
+  std::vector< std::pair<vertexIdType, vertexIdType> > edgeList;
+
+  for(vertexIdType i = comm.rank() * 100; i < (comm.rank() + 1) * 100; i++)
+  {
+    edgeList.emplace_back(i*10 + 3, (i+1)*10 + 3);
+    edgeList.emplace_back((i+1)*10 + 3, i*10 + 3);
+  }
+
+  auto originalEdgeList = edgeList;
+
+  std::vector<vertexIdType> uniqueVertexList;
+  conn::graphGen::reduceVertexIds(edgeList, uniqueVertexList, comm);
+
+  //Edge order is unchanged by the hash based engine
+  ASSERT_EQ(edgeList.size(), originalEdgeList.size());
+
+  auto fullEdgeList = mxx::gatherv(edgeList, 0, comm);
+  auto fullOriginalEdgeList = mxx::gatherv(originalEdgeList, 0, comm);
+  auto fullMapping = mxx::gatherv(uniqueVertexList, 0, comm);
+
+  if(!comm.rank())
+  {
+    ASSERT_EQ(fullMapping.size(), comm.size() * 100 + 1);
+
+    for(std::size_t i = 0; i < fullEdgeList.size(); i++)
+    {
+      ASSERT_TRUE(fullEdgeList[i].first >= 0 && fullEdgeList[i].first < fullMapping.size());
+      ASSERT_TRUE(fullEdgeList[i].second >= 0 && fullEdgeList[i].second < fullMapping.size());
+
+      ASSERT_EQ(fullMapping[fullEdgeList[i].first], fullOriginalEdgeList[i].first);
+      ASSERT_EQ(fullMapping[fullEdgeList[i].second], fullOriginalEdgeList[i].second);
+    }
+  }
+}
+
+/*
+ * @brief   Test the chunked file reader, using chunks much smaller than a
+ *          rank's share so that records are carried over between chunks
+ *          FILE : src/test/data/graphDirChain.txt
+ */
+TEST(graphGen, graphFileIOChunked) {
+
+  mxx::comm comm = mxx::comm();
+
+  std::string fileName = PROJECT_TEST_DATA_FOLDER;
+  fileName = fileName + "/graphDirChain.txt";
+
+  using vertexIdType = int64_t;
+
+  for(std::size_t chunkSize : {5UL, 64UL, 1UL << 20})
+  {
+    std::vector< std::pair<vertexIdType, vertexIdType> > edgeList;
+
+    {
+      conn::graphGen::GraphFileParser<char *, vertexIdType> g(edgeList, false, fileName, comm);
+      g.populateEdgeListChunked(chunkSize);
+    }
+
+    auto fullEdgeList = mxx::gatherv(edgeList, 0, comm);
+
+    if(!comm.rank())
+    {
+      std::sort(fullEdgeList.begin(), fullEdgeList.end());
+
+      ASSERT_EQ(fullEdgeList.size(), 1200);
+
+      //Directed chain 1-2, 2-3, ... 1200-1201
+      for(int i = 0; i < fullEdgeList.size(); i++)
+      {
+        ASSERT_EQ(fullEdgeList[i].first, i + 1);
+        ASSERT_EQ(fullEdgeList[i].second, i + 2);
+      }
+    }
+  }
+}
+
+/*
+ * @brief   Test reading the chain split into files of uneven sizes, given as
+ *          a directory, a glob pattern and a comma separated list, and as a
+ *          directory or a pattern naming a single file
+ */
+TEST(graphGen, graphFileIOMultiple) {
+
+  mxx::comm comm = mxx::comm();
+
+  using vertexIdType = int64_t;
+
+  std::string dirName = "graphFileIOMultiple.test";
+  std::vector<int> fileEdges = {1, 300, 0, 7, 892};
+
+  if(!comm.rank())
+  {
+    mkdir(dirName.c_str(), 0755);
+
+    for(int i = 0, u = 1; i < fileEdges.size(); i++)
+    {
+      std::ofstream f(dirName + "/part" + std::to_string(i) + ".txt");
+
+      for(int j = 0; j < fileEdges[i]; j++, u++)
+        f << u << " " << u + 1 << "\n";
+    }
+
+    //Directory holding a single file, skipped while listing the parent directory
+    mkdir((dirName + "/single").c_str(), 0755);
+
+    std::ofstream f(dirName + "/single/all.txt");
+    for(int u = 1; u <= 1200; u++)
+      f << u << " " << u + 1 << "\n";
+  }
+
+  comm.barrier();
+
+  std::string listed = dirName + "/part0.txt," + dirName + "/part[1-2].txt," + dirName + "/part3.txt," + dirName + "/part4.txt";
+
+  for(std::string input : {dirName, dirName + "/part*.txt", listed, dirName + "/single", dirName + "/single/*.txt"})
+  {
+    std::vector< std::pair<vertexIdType, vertexIdType> > edgeList;
+
+    {
+      conn::graphGen::GraphFileParser<char *, vertexIdType> g(edgeList, false, input, comm);
+      g.populateEdgeList();
+    }
+
+    auto fullEdgeList = mxx::gatherv(edgeList, 0, comm);
+
+    if(!comm.rank())
+    {
+      std::sort(fullEdgeList.begin(), fullEdgeList.end());
+
+      ASSERT_EQ(fullEdgeList.size(), 1200);
+
+      for(int i = 0; i < fullEdgeList.size(); i++)
+      {
+        ASSERT_EQ(fullEdgeList[i].first, i + 1);
+        ASSERT_EQ(fullEdgeList[i].second, i + 2);
+      }
+    }
+  }
+
+  if(!comm.rank())
+  {
+    for(int i = 0; i < fileEdges.size(); i++)
+      std::remove((dirName + "/part" + std::to_string(i) + ".txt").c_str());
+
+    std::remove((dirName + "/single/all.txt").c_str());
+    rmdir((dirName + "/single").c_str());
+    rmdir(dirName.c_str());
+  }
+}
+
+/*
+ * @brief   Test routing of the edges to the owner of their source vertex while
+ *          parsing, every edge should be present on the owner rank only
+ *          FILE : src/test/data/graphDirChain.txt
+ */
+TEST(graphGen, graphFileIORouted) {
+
+  mxx::comm comm = mxx::comm();
+
+  std::string fileName = PROJECT_TEST_DATA_FOLDER;
+  fileName = fileName + "/graphDirChain.txt";
+
+  using vertexIdType = int64_t;
+
+  std::vector< std::pair<vertexIdType, vertexIdType> > edgeList;
+
+  {
+    conn::graphGen::GraphFileParser<char *, vertexIdType> g(edgeList, true, fileName, comm, false,
+        conn::graphGen::edgeListFormat(), true);
+    g.populateEdgeList();
+  }
+
+  conn::graphGen::vertexToHashOwner<vertexIdType> vertexRankAssigner(comm.size());
+
+  for(auto &e : edgeList)
+    ASSERT_EQ(vertexRankAssigner(e.first), comm.rank());
+
+  auto fullEdgeList = mxx::gatherv(edgeList, 0, comm);
+
+  if(!comm.rank())
+  {
+    std::sort(fullEdgeList.begin(), fullEdgeList.end());
+
+    ASSERT_EQ(fullEdgeList.size(), 2400);
+
+    //Vertex 1 has the single edge 1-2, others i-(i-1) and i-(i+1)
+    for(int i = 1; i < fullEdgeList.size(); i++)
+      ASSERT_EQ(fullEdgeList[i].first, (i + 1) / 2 + 1);
+  }
+}
+
+/*
+ * @brief   Test the parser over records with comments, CR/LF endings, tabs,
+ *          long vertex ids and invalid lines, all of which should be skipped
+ *          except the edges
+ */
+TEST(graphGen, graphFileParserRecords) {
+
+  mxx::comm comm = mxx::comm();
+
+  using vertexIdType = int64_t;
+
+  std::string fileName = "graphFileParser.test.txt";
+
+  const int edgeCount = 1000;
+
+  if(!comm.rank())
+  {
+    std::ofstream f(fileName);
+
+    f << "% header comment\n%another comment\n";
+
+    for(int i = 0; i < edgeCount; i++)
+    {
+      //Long ids exercise the 8 digit parsing
+      vertexIdType u = 1234567890123LL + i, v = i;
+
+      switch(i % 4)
+      {
+        case 0: f << u << " " << v << "\n"; break;
+        case 1: f << u << " " << v << "\r\n"; break;
+        case 2: f << u << "\t" << v << "  \n"; break;
+        case 3: f << u << " " << v << "\n% comment\n1 two\n\nfoo bar\n"; break;
+      }
+    }
+  }
+
+  comm.barrier();
+
+  std::vector< std::pair<vertexIdType, vertexIdType> > edgeList;
+
+  {
+    conn::graphGen::GraphFileParser<char *, vertexIdType> g(edgeList, false, fileName, comm);
+    g.populateEdgeList();
+  }
+
+  auto fullEdgeList = mxx::gatherv(edgeList, 0, comm);
+
+  if(!comm.rank())
+  {
+    std::sort(fullEdgeList.begin(), fullEdgeList.end(), conn::utils::TpleComp<1>());
+
+    ASSERT_EQ(fullEdgeList.size(), edgeCount);
+
+    for(int i = 0; i < edgeCount; i++)
+    {
+      ASSERT_EQ(fullEdgeList[i].first, 1234567890123LL + i);
+      ASSERT_EQ(fullEdgeList[i].second, i);
+    }
+
+    std::remove(fileName.c_str());
+  }
+}
+
+/*
+ * @brief   Test the Matrix Market and weighted formats, the size header should
+ *          be skipped and the edges below the weight threshold dropped
+ */
+TEST(graphGen, graphFileParserFormats) {
+
+  mxx::comm comm = mxx::comm();
+
+  using vertexIdType = int64_t;
+
+  std::string fileName = "graphFileParser.test.mtx";
+
+  const int edgeCount = 1000;
+
+  if(!comm.rank())
+  {
+    std::ofstream f(fileName);
+
+    f << "%%MatrixMarket matrix coordinate real general\n% comment\n";
+    f << edgeCount + 1 << " " << edgeCount + 1 << " " << edgeCount << "\n";
+
+    //Odd edges are heavy
+    for(int i = 0; i < edgeCount; i++)
+      f << i << "\t" << i + 1 << "\t" << (i % 2 ? "2.5e0" : "0.25") << "\n";
+  }
+
+  comm.barrier();
+
+  auto format = conn::graphGen::edgeListFormat::fromFileName(fileName);
+  ASSERT_TRUE(format.sizeHeader);
+
+  for(bool threshold : {false, true})
+  {
+    format.weightColumn = 2;
+    format.minWeight = threshold ? 1.0 : 0.0;
+
+    std::vector< std::pair<vertexIdType, vertexIdType> > edgeList;
+
+    {
+      conn::graphGen::GraphFileParser<char *, vertexIdType> g(edgeList, false, fileName, comm, false, format);
+      g.populateEdgeList();
+    }
+
+    auto fullEdgeList = mxx::gatherv(edgeList, 0, comm);
+
+    if(!comm.rank())
+    {
+      std::sort(fullEdgeList.begin(), fullEdgeList.end());
+
+      ASSERT_EQ(fullEdgeList.size(), threshold ? edgeCount / 2 : edgeCount);
+
+      for(std::size_t i = 0; i < fullEdgeList.size(); i++)
+      {
+        vertexIdType u = threshold ? 2*i + 1 : i;
+        ASSERT_EQ(fullEdgeList[i].first, u);
+        ASSERT_EQ(fullEdgeList[i].second, u + 1);
+      }
+    }
+  }
+
+  if(!comm.rank())
+    std::remove(fileName.c_str());
+}
+
+#ifdef CONN_HAVE_ZLIB
+/*
+ * @brief   Test the parallel reading of a BGZF compressed edge list,
+ *          blocks are kept small so that records straddle the blocks and ranks
+ */
+TEST(graphGen, graphFileParserBgzf) {
+
+  mxx::comm comm = mxx::comm();
+
+  using vertexIdType = int64_t;
+
+  std::string fileName = "graphFileParser.test.txt.gz";
+
+  const int edgeCount = 5000;
+
+  if(!comm.rank())
+  {
+    std::stringstream text;
+    for(int i = 0; i < edgeCount; i++)
+      text << i << " " << i + 1 << "\n";
+
+    std::string plain = text.str();
+    std::ofstream out(fileName, std::ios::out | std::ios::binary);
+
+    //Block layout as written by bgzip, with an empty block marking the end of file
+    for(std::size_t begin = 0; ; begin += 1000)
+    {
+      std::size_t length = begin < plain.size() ? std::min<std::size_t>(1000, plain.size() - begin) : 0;
+
+      std::vector<unsigned char> payload(compressBound(length) + 16);
+
+      z_stream zs = {};
+      deflateInit2(&zs, 6, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+      zs.next_in = reinterpret_cast<unsigned char*>(&plain[begin]);
+      zs.avail_in = length;
+      zs.next_out = payload.data();
+      zs.avail_out = payload.size();
+      deflate(&zs, Z_FINISH);
+      std::size_t payloadSize = zs.total_out;
+      deflateEnd(&zs);
+
+      uint32_t crc = crc32(0, reinterpret_cast<unsigned char*>(&plain[begin]), length);
+      uint16_t bsize = payloadSize + 25;
+      unsigned char header[18] = {31, 139, 8, 4, 0, 0, 0, 0, 0, 255, 6, 0, 'B', 'C', 2, 0,
+        static_cast<unsigned char>(bsize & 0xFF), static_cast<unsigned char>(bsize >> 8)};
+
+      out.write(reinterpret_cast<char*>(header), 18);
+      out.write(reinterpret_cast<char*>(payload.data()), payloadSize);
+      out.write(reinterpret_cast<char*>(&crc), 4);
+      uint32_t isize = length;
+      out.write(reinterpret_cast<char*>(&isize), 4);
+
+      if(length == 0) break;
+    }
+  }
+
+  comm.barrier();
+
+  std::vector< std::pair<vertexIdType, vertexIdType> > edgeList;
+
+  {
+    conn::graphGen::GraphFileParser<char *, vertexIdType> g(edgeList, false, fileName, comm);
+    g.populateEdgeList();
+  }
+
+  auto fullEdgeList = mxx::gatherv(edgeList, 0, comm);
+
+  if(!comm.rank())
+  {
+    std::sort(fullEdgeList.begin(), fullEdgeList.end());
+
+    ASSERT_EQ(fullEdgeList.size(), edgeCount);
+
+    for(int i = 0; i < edgeCount; i++)
+    {
+      ASSERT_EQ(fullEdgeList[i].first, i);
+      ASSERT_EQ(fullEdgeList[i].second, i + 1);
+    }
+
+    std::remove(fileName.c_str());
+  }
+}
+#endif
+
+/*
+ * @brief   Test that the binary files written by writeEdgeListBinaryFormat
+ *          are read back, with the reverse edges added, on any count of ranks
+ */
+TEST(graphGen, binaryGraphReader) {
+
+  mxx::comm comm = mxx::comm();
+
+  using vertexIdType = int64_t;
+
+  std::vector< std::pair<vertexIdType, vertexIdType> > edgeList;
+
+  //Chain over this rank's vertices, plus a link to the next rank
+  for(vertexIdType i = comm.rank() * 100; i < (comm.rank() + 1) * 100; i++)
+  {
+    edgeList.emplace_back(i, i+1);
+    edgeList.emplace_back(i+1, i);
+  }
+
+  auto fullEdgeList = mxx::gatherv(edgeList, 0, comm);
+
+  std::string outputPath = "binaryGraphReader.test";
+
+  if(!comm.rank())
+    mkdir(outputPath.c_str(), 0755);
+
+  comm.barrier();
+
+  conn::graphGen::writeEdgeListBinaryFormat(edgeList, outputPath, comm);
+
+  comm.barrier();
+
+  //Read back using a single rank, and using all the ranks
+  for(int readers : {1, comm.size()})
+  {
+    std::vector< std::pair<vertexIdType, vertexIdType> > edgeListRead;
+
+    comm.with_subset(comm.rank() < readers, [&](const mxx::comm &comm){
+        conn::graphGen::BinaryGraphReader<vertexIdType> reader(comm);
+        reader.populateEdgeList(edgeListRead, outputPath);
+        });
+
+    auto fullEdgeListRead = mxx::gatherv(edgeListRead, 0, comm);
+
+    if(!comm.rank())
+    {
+      std::sort(fullEdgeList.begin(), fullEdgeList.end());
+      std::sort(fullEdgeListRead.begin(), fullEdgeListRead.end());
+
+      ASSERT_TRUE(fullEdgeListRead == fullEdgeList);
+    }
+  }
+
+  comm.barrier();
+
+  if(!comm.rank())
+  {
+    for(int i = 0; i < comm.size(); i++)
+      std::remove((outputPath + "/graph." + std::to_string(i) + ".bin").c_str());
+
+    rmdir(outputPath.c_str());
+  }
+}
+
+/*
+ * @brief   Test that the labels can be translated back to the original ids
+ *          after permuting and relabeling them, including a round trip of the
+ *          mapping table through a file
+ */
+TEST(graphGen, translateLabelsThroughMapping) {
+
+  mxx::comm comm = mxx::comm();
+
+  using vertexIdType = int64_t;
+
+  std::vector< std::pair<vertexIdType, vertexIdType> > edgeList;
+
+  for(vertexIdType i = comm.rank() * 100; i < (comm.rank() + 1) * 100; i++)
+  {
+    edgeList.emplace_back(i*10 + 3, (i+1)*10 + 3);
+    edgeList.emplace_back((i+1)*10 + 3, i*10 + 3);
+  }
+
+  auto originalEdgeList = edgeList;
+
+  conn::graphGen::permuteVectorIds(edgeList);
+
+  std::size_t nVertices;
+  std::vector<vertexIdType> uniqueVertexList;
+  conn::graphGen::reduceVertexIdsUsingHash(edgeList, nVertices, comm, &uniqueVertexList);
+
+  std::string fileName = "idMapping.test.bin";
+
+  {
+    conn::graphGen::idMapping<vertexIdType> mapping(uniqueVertexList, comm);
+    mapping.write(fileName);
+  }
+
+  auto mapping = conn::graphGen::idMapping<vertexIdType>::read(fileName, comm);
+
+  ASSERT_EQ(mapping.size(), nVertices);
+
+  //Treat the edges as <vertex, label> pairs
+  conn::graphGen::translateLabels(edgeList, &mapping, true);
+
+  ASSERT_TRUE(edgeList == originalEdgeList);
+
+  if(!comm.rank())
+    std::remove(fileName.c_str());
+}
+
+/*
+ * @brief   Test that the batched hash kernels match the scalar hash functions
+ *          for all array lengths, covering both the vector body and scalar tail
+ */
+TEST(graphGen, hashKernelsBatch) {
+
+  std::mt19937_64 gen(42);
+
+  for(std::size_t n : {0UL, 1UL, 7UL, 9UL, 100003UL})
+  {
+    std::vector<uint64_t> keys(n);
+    std::generate(keys.begin(), keys.end(), gen);
+
+    if(n > 1)
+    {
+      keys[0] = 0;
+      keys[1] = ~0ULL;
+    }
+
+    auto expected = keys;
+    for(auto &k : expected)
+      conn::graphGen::hash_64(k);
+
+    auto hashed = keys;
+    conn::graphGen::hash_64_batch(hashed.data(), hashed.size());
+
+    ASSERT_TRUE(hashed == expected);
+
+    conn::graphGen::hash_64i_batch(hashed.data(), hashed.size());
+
+    ASSERT_TRUE(hashed == keys);
+
+    //Every instruction set compiled in, against the scalar reference
+    using namespace conn::graphGen::hashLanes;
+
+    hashed = keys;
+    applyRange<scalarOps, forward>(hashed.data(), hashed.size());
+    ASSERT_TRUE(hashed == expected);
+    applyRange<scalarOps, inverse>(hashed.data(), hashed.size());
+    ASSERT_TRUE(hashed == keys);
+
+#if defined(__AVX2__)
+    hashed = keys;
+    applyRange<avx2Ops, forward>(hashed.data(), hashed.size());
+    ASSERT_TRUE(hashed == expected);
+    applyRange<avx2Ops, inverse>(hashed.data(), hashed.size());
+    ASSERT_TRUE(hashed == keys);
+#endif
+
+#if defined(__AVX512F__)
+    hashed = keys;
+    applyRange<avx512Ops, forward>(hashed.data(), hashed.size());
+    ASSERT_TRUE(hashed == expected);
+    applyRange<avx512Ops, inverse>(hashed.data(), hashed.size());
+    ASSERT_TRUE(hashed == keys);
+#endif
+  }
+}
+
+/*
+ * @brief   Test the run segmentation used by the bucket processing loops
+ *          against a linear scan, over runs of length 1 to a few hundred
+ */
+TEST(graphGen, runSegmentation) {
+
+  using T = std::tuple<int, int, int>;
+  using Iterator = std::vector<T>::iterator;
+
+  std::mt19937 gen(7);
+
+  for(int runLength : {1, 2, 3, 17, 300})
+  {
+    std::vector<T> tuples;
+
+    for(int key = 0; key < 50; key++)
+      for(int i = 0, n = 1 + gen() % runLength; i < n; i++)
+        tuples.emplace_back(key, gen() % 1000, 0);
+
+    std::size_t visited = 0;
+
+    conn::utils::forEachRunMinMax<0, 1>(tuples.begin(), tuples.end(), [&](Iterator runBegin, Iterator runEnd, Iterator minIt, Iterator maxIt)
+    {
+      ASSERT_TRUE(runBegin == tuples.begin() + visited);
+
+      for(auto it = runBegin; it != runEnd; it++)
+      {
+        ASSERT_EQ(std::get<0>(*it), std::get<0>(*runBegin));
+        ASSERT_LE(std::get<1>(*minIt), std::get<1>(*it));
+        ASSERT_GE(std::get<1>(*maxIt), std::get<1>(*it));
+      }
+
+      if(runEnd != tuples.end())
+        ASSERT_NE(std::get<0>(*runEnd), std::get<0>(*runBegin));
+
+      visited += std::distance(runBegin, runEnd);
+    });
+
+    ASSERT_EQ(visited, tuples.size());
+  }
+}
+
+/*
+ * @brief   Test the streaming de Bruijn edge generation, a genome written as
+ *          multi-line FASTA and as overlapping FASTQ reads (some reverse
+ *          complemented) should give the same edges, each present once on the
+ *          owner of its source k-mer
+ */
+TEST(graphGen, kmerEdgeStream) {
+
+  mxx::comm comm = mxx::comm();
+
+  using vertexIdType = int64_t;
+
+  const unsigned int k = 15;
+
+  std::string fastaFile = "kmerEdgeStream.test.fa";
+  std::string fastqFile = "kmerEdgeStream.test.fq";
+
+  std::mt19937 gen(11);
+  std::string genome;
+  for(int i = 0; i < 5000; i++)
+    genome.push_back("ACGT"[gen() % 4]);
+
+  if(!comm.rank())
+  {
+    std::ofstream fa(fastaFile);
+    fa << ">genome description\n";
+    for(std::size_t i = 0; i < genome.size(); i += 7)
+      fa << genome.substr(i, 7) << "\n";
+
+    std::ofstream fq(fastqFile);
+    for(std::size_t i = 0, r = 0; i + k < genome.size(); i += 30, r++)
+    {
+      std::string read = genome.substr(i, 50);
+
+      if(r % 2)
+      {
+        std::reverse(read.begin(), read.end());
+        for(auto &c : read)
+          c = c == 'A' ? 'T' : c == 'C' ? 'G' : c == 'G' ? 'C' : 'A';
+      }
+
+      //Quality lines beginning with '@' should not be taken as records
+      fq << "@read" << r << "\n" << read << "\n+\n" << std::string(read.size(), '@') << "\n";
+    }
+  }
+
+  comm.barrier();
+
+  //Distinct edges of the genome
+  std::set< std::pair<vertexIdType, vertexIdType> > expected;
+  {
+    conn::graphGen::kmerWindow window(k);
+    uint64_t previous = 0;
+
+    for(auto c : genome)
+    {
+      window.push(c);
+
+      if(window.length > k && previous != window.canonical())
+      {
+        expected.emplace(previous, window.canonical());
+        expected.emplace(window.canonical(), previous);
+      }
+
+      if(window.length >= k)
+        previous = window.canonical();
+    }
+  }
+
+  conn::graphGen::vertexToHashOwner<vertexIdType> vertexRankAssigner(comm.size());
+
+  for(auto &fileName : {fastaFile, fastqFile})
+  {
+    std::vector< std::pair<vertexIdType, vertexIdType> > edgeList;
+
+    conn::graphGen::kmerEdgeStream<vertexIdType> stream(comm, k);
+    stream.populateEdgeList(edgeList, fileName);
+
+    for(auto &e : edgeList)
+      ASSERT_EQ(vertexRankAssigner(e.first), comm.rank());
+
+    auto fullEdgeList = mxx::gatherv(edgeList, 0, comm);
+
+    if(!comm.rank())
+    {
+      std::sort(fullEdgeList.begin(), fullEdgeList.end());
+
+      ASSERT_TRUE(std::equal(fullEdgeList.begin(), fullEdgeList.end(), expected.begin(), expected.end()));
+    }
+  }
+
+  if(!comm.rank())
+  {
+    std::remove(fastaFile.c_str());
+    std::remove(fastqFile.c_str());
+  }
+}
+
+/*
+ * @brief   Test the abundance filter of the de Bruijn graph, reads covering a genome
+ *          three times plus reads seen once (as with sequencing errors) should give
+ *          the edges of the genome reads alone when edges seen fewer than 3 times
+ *          are dropped
+ */
+TEST(graphGen, deBruijnMinAbundance) {
+
+  mxx::comm comm = mxx::comm();
+
+  using vertexIdType = int64_t;
+
+  const unsigned int k = 21;
+
+  std::string genomeFile = "deBruijnMinAbundance.genome.test.fq";
+  std::string noisyFile = "deBruijnMinAbundance.noisy.test.fq";
+
+  if(!comm.rank())
+  {
+    std::mt19937 gen(13);
+    std::string genome;
+    for(int i = 0; i < 5000; i++)
+      genome.push_back("ACGT"[gen() % 4]);
+
+    std::ofstream fqGenome(genomeFile);
+    std::ofstream fqNoisy(noisyFile);
+
+    for(std::size_t i = 0, r = 0; i + k < genome.size(); i += 30, r++)
+    {
+      std::string read = genome.substr(i, 50);
+
+      fqGenome << "@read" << r << "\n" << read << "\n+\n" << std::string(read.size(), 'I') << "\n";
+
+      for(int copy = 0; copy < 3; copy++)
+        fqNoisy << "@read" << r << "_" << copy << "\n" << read << "\n+\n" << std::string(read.size(), 'I') << "\n";
+
+      //Random read, seen once
+      if(r % 4 == 0)
+      {
+        std::string error;
+        for(int j = 0; j < 50; j++)
+          error.push_back("ACGT"[gen() % 4]);
+
+        fqNoisy << "@error" << r << "\n" << error << "\n+\n" << std::string(error.size(), 'I') << "\n";
+      }
+    }
+  }
+
+  comm.barrier();
+
+  std::vector< std::pair<vertexIdType, vertexIdType> > genomeEdgeList, noisyEdgeList, unfilteredEdgeList;
+
+  {
+    conn::graphGen::deBruijnGraph g(k);
+    g.populateEdgeList(genomeEdgeList, genomeFile, comm);
+    g.populateEdgeList(unfilteredEdgeList, noisyFile, comm);
+  }
+
+  {
+    conn::graphGen::deBruijnGraph g(k, false, false, 3);
+    g.populateEdgeList(noisyEdgeList, noisyFile, comm);
+  }
+
+  auto fullGenomeEdgeList = mxx::gatherv(genomeEdgeList, 0, comm);
+  auto fullNoisyEdgeList = mxx::gatherv(noisyEdgeList, 0, comm);
+  auto fullUnfilteredEdgeList = mxx::gatherv(unfilteredEdgeList, 0, comm);
+
+  if(!comm.rank())
+  {
+    std::sort(fullGenomeEdgeList.begin(), fullGenomeEdgeList.end());
+    std::sort(fullNoisyEdgeList.begin(), fullNoisyEdgeList.end());
+
+    ASSERT_FALSE(fullGenomeEdgeList.empty());
+    ASSERT_TRUE(fullNoisyEdgeList == fullGenomeEdgeList);
+
+    //Without the filter, the random reads add their own edges
+    ASSERT_GT(fullUnfilteredEdgeList.size(), fullGenomeEdgeList.size());
+
+    std::remove(genomeFile.c_str());
+    std::remove(noisyFile.c_str());
+  }
+}
+
+/*
+ * @brief   Test the vertex ids of k-mers longer than 32, given by 64-bit fingerprints,
+ *          the genome k-mers and edges should map to as many distinct vertices and edges
+ */
+TEST(graphGen, deBruijnLongKmers) {
+
+  mxx::comm comm = mxx::comm();
+
+  using vertexIdType = int64_t;
+
+  const unsigned int k = 41;
+
+  std::string fastqFile = "deBruijnLongKmers.test.fq";
+
+  std::mt19937 gen(19);
+  std::string genome;
+  for(int i = 0; i < 5000; i++)
+    genome.push_back("ACGT"[gen() % 4]);
+
+  if(!comm.rank())
+  {
+    std::ofstream fq(fastqFile);
+    for(std::size_t i = 0, r = 0; i + k < genome.size(); i += 30, r++)
+    {
+      std::string read = genome.substr(i, 80);
+      fq << "@read" << r << "\n" << read << "\n+\n" << std::string(read.size(), 'I') << "\n";
+    }
+  }
+
+  comm.barrier();
+
+  std::vector< std::pair<vertexIdType, vertexIdType> > edgeList;
+
+  {
+    conn::graphGen::deBruijnGraph g(k);
+    g.populateEdgeList(edgeList, fastqFile, comm);
+  }
+
+  auto fullEdgeList = mxx::gatherv(edgeList, 0, comm);
+
+  if(!comm.rank())
+  {
+    //Distinct canonical k-mers and edges of the genome
+    auto canonical = [](std::string kmer){
+      std::string reverse(kmer.rbegin(), kmer.rend());
+      for(auto &c : reverse)
+        c = c == 'A' ? 'T' : c == 'C' ? 'G' : c == 'G' ? 'C' : 'A';
+      return std::min(kmer, reverse);
+    };
+
+    std::set<std::string> kmers;
+    std::set< std::pair<std::string, std::string> > edges;
+
+    for(std::size_t i = 0; i + k <= genome.size(); i++)
+    {
+      kmers.insert(canonical(genome.substr(i, k)));
+
+      if(i + k < genome.size())
+      {
+        auto u = canonical(genome.substr(i, k)), v = canonical(genome.substr(i + 1, k));
+        edges.emplace(std::min(u, v), std::max(u, v));
+      }
+    }
+
+    std::set<vertexIdType> vertexIds;
+    std::set< std::pair<vertexIdType, vertexIdType> > vertexPairs;
+
+    for(auto &e : fullEdgeList)
+    {
+      vertexIds.insert(e.first);
+      vertexIds.insert(e.second);
+      vertexPairs.emplace(std::min(e.first, e.second), std::max(e.first, e.second));
+    }
+
+    ASSERT_EQ(vertexIds.size(), kmers.size());
+    ASSERT_EQ(vertexPairs.size(), edges.size());
+
+    std::remove(fastqFile.c_str());
+  }
+}
+
+/*
+ * @brief   Test the compaction of non-branching paths, over a graph of random paths,
+ *          cycles and a few random extra edges. Compacted graph should have the same
+ *          components, and a single vertex per non-branching chain
+ */
+TEST(graphGen, unitigCompaction) {
+
+  mxx::comm comm = mxx::comm();
+
+  using vertexIdType = int64_t;
+
+  const int n = 4000;
+
+  //Same graph on all the ranks, random distinct ids
+  std::mt19937_64 gen(17);
+
+  std::vector<vertexIdType> ids(n);
+  for(auto &id : ids)
+    id = gen() >> 24;
+
+  std::vector< std::set<int> > adjacency(n);
+  auto addEdge = [&](int u, int v){ adjacency[u].insert(v); adjacency[v].insert(u); };
+
+  //Paths of random lengths, some closed into cycles
+  for(int begin = 0, path = 0; begin < n; path++)
+  {
+    int end = std::min<int>(n, begin + 1 + gen() % 200);
+
+    for(int i = begin; i + 1 < end; i++)
+      addEdge(i, i + 1);
+
+    if(path % 10 == 3 && end - begin >= 3)
+      addEdge(end - 1, begin);
+
+    if(end - begin == 1)
+      addEdge(begin, begin);
+
+    begin = end;
+  }
+
+  for(int i = 0; i < 40; i++)
+    addEdge(gen() % n, gen() % n);
+
+  auto components = [](std::map<vertexIdType, vertexIdType> &parent, const std::vector< std::pair<vertexIdType, vertexIdType> > &edges){
+    std::function<vertexIdType(vertexIdType)> root = [&](vertexIdType v){ return parent[v] == v ? v : parent[v] = root(parent[v]); };
+
+    for(auto &e : edges)
+    {
+      if(!parent.count(e.first)) parent[e.first] = e.first;
+      if(!parent.count(e.second)) parent[e.second] = e.second;
+      parent[root(e.first)] = root(e.second);
+    }
+
+    std::size_t count = 0;
+    for(auto &v : parent)
+      if(root(v.first) == v.first) count++;
+
+    return count;
+  };
+
+  std::vector< std::pair<vertexIdType, vertexIdType> > edgeList;
+
+  {
+    conn::graphGen::edgeRouter<vertexIdType> router(edgeList, comm);
+    conn::graphGen::unitigCompaction<vertexIdType> compaction(comm);
+
+    for(int i = comm.rank(); i < n; i += comm.size())
+    {
+      std::vector<vertexIdType> adjacent;
+      for(auto v : adjacency[i])
+        adjacent.push_back(ids[v]);
+
+      compaction.addKmer(ids[i], adjacent, adjacency[i].size() - adjacency[i].count(i) <= 2);
+    }
+
+    compaction.populateEdgeList(router);
+    router.finish();
+  }
+
+  conn::graphGen::vertexToHashOwner<vertexIdType> vertexRankAssigner(comm.size());
+
+  for(auto &e : edgeList)
+    ASSERT_EQ(vertexRankAssigner(e.first), comm.rank());
+
+  auto fullEdgeList = mxx::gatherv(edgeList, 0, comm);
+
+  if(!comm.rank())
+  {
+    std::vector< std::pair<vertexIdType, vertexIdType> > edges, chainEdges;
+    for(int u = 0; u < n; u++)
+      for(auto v : adjacency[u])
+      {
+        edges.emplace_back(ids[u], ids[v]);
+
+        bool chained = u != v && adjacency[u].size() - adjacency[u].count(u) <= 2 && adjacency[v].size() - adjacency[v].count(v) <= 2;
+        chainEdges.emplace_back(ids[u], chained ? ids[v] : ids[u]);
+      }
+
+    std::map<vertexIdType, vertexIdType> original, chains, compacted;
+
+    std::size_t vertexCount = components(chains, chainEdges);
+
+    ASSERT_EQ(components(compacted, fullEdgeList), components(original, edges));
+    ASSERT_EQ(compacted.size(), vertexCount);
+    ASSERT_LT(compacted.size() * 10, original.size());
+
+    //Compacted vertex ids are the smallest ids of their chains
+    auto chainRoot = [&](vertexIdType v){ while(chains[v] != v) v = chains[v]; return v; };
+
+    std::map<vertexIdType, vertexIdType> smallest;
+    for(auto &v : chains)
+    {
+      vertexIdType r = chainRoot(v.first);
+      if(!smallest.count(r) || v.first < smallest[r]) smallest[r] = v.first;
+    }
+
+    for(auto &v : compacted)
+      ASSERT_EQ(smallest[chainRoot(v.first)], v.first);
+  }
+}